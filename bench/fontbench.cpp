@@ -0,0 +1,180 @@
+/**
+ * Glyph lookup microbenchmark (layout time vs. loaded glyph count).
+ *
+ * Build & run: npm run bench:font
+ */
+
+#include "texture-font.h"
+#include "utf8-utils.h"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+#define FONT_FILE "resources/SourceSansPro-Regular.ttf"
+#define TEXT_LENGTH 1000
+#define ITERATIONS 100
+
+using namespace ftgl;
+
+/**
+ * Get time in milliseconds.
+ */
+static double now() {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Previous lookup (linear scan of the glyphs vector).
+ */
+static texture_glyph_t *findGlyphLinear(texture_font_t *font, const char *codepoint) {
+    uint32_t ucodepoint = utf8_to_utf32(codepoint);
+
+    for (size_t i = 0; i < font->glyphs->size; i++) {
+        texture_glyph_t *glyph = *(texture_glyph_t **)vector_get(font->glyphs, i);
+
+        if (glyph->codepoint == ucodepoint && (ucodepoint == UINT32_MAX || (glyph->rendermode == font->rendermode && glyph->outline_thickness == font->outline_thickness))) {
+            return glyph;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Append a codepoint in UTF-8 encoding (BMP only).
+ */
+static void appendUtf8(std::string &str, uint32_t codepoint) {
+    if (codepoint < 0x80) {
+        str += (char)codepoint;
+    } else if (codepoint < 0x800) {
+        str += (char)(0xC0 | (codepoint >> 6));
+        str += (char)(0x80 | (codepoint & 0x3F));
+    } else {
+        str += (char)(0xE0 | (codepoint >> 12));
+        str += (char)(0x80 | ((codepoint >> 6) & 0x3F));
+        str += (char)(0x80 | (codepoint & 0x3F));
+    }
+}
+
+/**
+ * Look up all glyphs of a text (like AminoText::addTextGlyphs()).
+ */
+static double layout(texture_font_t *font, const std::string &text, texture_glyph_t *(*find)(texture_font_t *, const char *), size_t &found) {
+    const char *str = text.c_str();
+    size_t len = text.length();
+
+    found = 0;
+
+    double start = now();
+
+    for (int j = 0; j < ITERATIONS; j++) {
+        for (size_t i = 0; i < len; i += utf8_surrogate_len(str + i)) {
+            if (find(font, str + i)) {
+                found++;
+            }
+        }
+    }
+
+    return (now() - start) / ITERATIONS;
+}
+
+/**
+ * Rasterize glyphs and look up the kerning of all pairs in a text.
+ */
+static void loadGlyphs() {
+    texture_atlas_t *atlas = texture_atlas_new(1024, 1024, 1);
+    texture_font_t *font = texture_font_new_from_file(atlas, 24, FONT_FILE, NULL);
+    std::string text;
+
+    //Latin-1 & Latin Extended-A
+    for (uint32_t codepoint = 0x21; codepoint < 0x180; codepoint++) {
+        if (codepoint < 0x7F || codepoint > 0xA0) {
+            appendUtf8(text, codepoint);
+        }
+    }
+
+    const char *str = text.c_str();
+    size_t len = text.length();
+    double start = now();
+
+    for (size_t i = 0; i < len; i += utf8_surrogate_len(str + i)) {
+        texture_font_load_glyph(font, str + i);
+    }
+
+    double load = now() - start;
+
+    //kerning (first lookup queries FreeType)
+    float kerning = 0;
+
+    start = now();
+
+    for (int j = 0; j < ITERATIONS; j++) {
+        const char *last = NULL;
+
+        for (size_t i = 0; i < len; i += utf8_surrogate_len(str + i)) {
+            texture_glyph_t *glyph = texture_font_find_glyph(font, str + i);
+
+            if (last) {
+                kerning += texture_font_get_kerning(font, glyph, last);
+            }
+
+            last = str + i;
+        }
+    }
+
+    double pairs = (now() - start) / ITERATIONS;
+
+    printf("glyph loading (%zu glyphs)\n", font->glyphs->size);
+    printf("-> load: %.1f ms\n", load);
+    printf("-> kerning: %.4f ms per text (sum %g)\n", pairs, kerning);
+
+    texture_font_delete(font);
+    texture_atlas_delete(atlas);
+}
+
+int main() {
+    size_t counts[] = { 100, 1000, 5000, 20000 };
+
+    loadGlyphs();
+
+    printf("glyph lookup (%i characters per layout)\n", TEXT_LENGTH);
+
+    for (size_t count : counts) {
+        texture_atlas_t *atlas = texture_atlas_new(512, 512, 1);
+        texture_font_t *font = texture_font_new_from_file(atlas, 24, FONT_FILE, NULL);
+
+        if (!font) {
+            printf("could not load %s\n", FONT_FILE);
+            return 1;
+        }
+
+        //fake CJK glyphs (no rasterization)
+        for (size_t i = 0; i < count; i++) {
+            texture_glyph_t *glyph = texture_glyph_new();
+
+            glyph->codepoint = 0x4E00 + i;
+            texture_font_add_glyph(font, glyph);
+        }
+
+        //text using random loaded glyphs
+        std::string text;
+        uint32_t seed = 1;
+
+        for (int i = 0; i < TEXT_LENGTH; i++) {
+            seed = seed * 1103515245 + 12345;
+            appendUtf8(text, 0x4E00 + (seed >> 8) % count);
+        }
+
+        size_t foundLinear, foundHash;
+        double linear = layout(font, text, findGlyphLinear, foundLinear);
+        double hash = layout(font, text, texture_font_find_glyph, foundHash);
+
+        printf("-> %zu glyphs: linear %.3f ms, hash %.4f ms (%.0fx)%s\n", count, linear, hash, linear / hash, foundLinear == foundHash ? "":" MISMATCH");
+
+        texture_font_delete(font);
+        texture_atlas_delete(atlas);
+    }
+
+    return 0;
+}
@@ -0,0 +1,98 @@
+/**
+ * Matrix kernel microbenchmark.
+ *
+ * Build & run: npm run bench:math
+ */
+
+#include "mathutils.h"
+
+#include <chrono>
+
+#define ITERATIONS 10000000
+#define NODES 1024
+
+/**
+ * Get time in milliseconds.
+ */
+static double now() {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Run a multiplication kernel.
+ */
+static double run(void (*kernel)(GLfloat *, const GLfloat *, const GLfloat *), GLfloat *res) {
+    GLfloat a[16], b[16];
+
+    make_z_rot_matrix(0.1f, a);
+    make_trans_matrix(0.5f, 0.25f, 0.f, b);
+    make_identity_matrix(res);
+
+    double start = now();
+
+    for (int i = 0; i < ITERATIONS; i++) {
+        kernel(res, res, (i & 1) ? a:b);
+    }
+
+    return now() - start;
+}
+
+/**
+ * Run a multiplication kernel on independent matrices (world transforms of a scene).
+ */
+static double runScene(void (*kernel)(GLfloat *, const GLfloat *, const GLfloat *)) {
+    static GLfloat local[NODES][16];
+    static GLfloat world[NODES][16];
+    GLfloat parent[16];
+
+    make_z_rot_matrix(30, parent);
+
+    for (int i = 0; i < NODES; i++) {
+        make_trans_matrix(i, i * 2, 0, local[i]);
+    }
+
+    double start = now();
+
+    for (int j = 0; j < ITERATIONS / NODES; j++) {
+        for (int i = 0; i < NODES; i++) {
+            kernel(world[i], parent, local[i]);
+        }
+
+        parent[12] += world[j % NODES][12] * 1e-9f;
+    }
+
+    return now() - start;
+}
+
+int main() {
+    GLfloat res1[16], res2[16];
+
+    double scalar = run(mul_matrix_scalar, res1);
+    double simd = run(mul_matrix, res2);
+
+    //check results
+    GLfloat maxDiff = 0;
+
+    for (int i = 0; i < 16; i++) {
+        GLfloat diff = fabs(res1[i] - res2[i]);
+
+        if (diff > maxDiff) {
+            maxDiff = diff;
+        }
+    }
+
+    printf("mul_matrix chain (%i iterations)\n", ITERATIONS);
+    printf("-> scalar: %.1f ms\n", scalar);
+    printf("-> %s: %.1f ms (%.2fx)\n", get_matrix_kernel_name(), simd, scalar / simd);
+    printf("-> max difference: %g\n", maxDiff);
+
+    //independent
+    scalar = runScene(mul_matrix_scalar);
+    simd = runScene(mul_matrix);
+
+    printf("mul_matrix scene (%i nodes)\n", NODES);
+    printf("-> scalar: %.1f ms\n", scalar);
+    printf("-> %s: %.1f ms (%.2fx)\n", get_matrix_kernel_name(), simd, scalar / simd);
+
+    return 0;
+}
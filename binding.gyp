@@ -25,7 +25,10 @@
 
                 "src/shaders.cpp",
                 "src/renderer.cpp",
-                "src/mathutils.cpp"
+                "src/mathutils.cpp",
+                "src/trace.cpp",
+                "src/hittest.cpp",
+                "src/layout.cpp"
             ],
             "include_dirs": [
                 "<!(node -e \"require('nan')\")",
@@ -134,6 +137,10 @@
                                         # RPi 4 support
                                         'RPI_BUILD="RPI 4 (Mesa, DRM, GBM)"',
                                         "EGL_GBM"
+                                    ],
+                                    "cflags": [
+                                        # NEON matrix kernels (Cortex-A72)
+                                        "-mfpu=neon-fp-armv8"
                                     ]
                                 }, {
                                     # RPi 3
@@ -213,7 +220,33 @@
                                 # NAN weak reference warning (remove later)
                                 "-Wno-class-memaccess"
                             ]
-		                }]
+		                }, {
+                            # Linux (headless, offscreen EGL)
+                            "sources": [
+                                "src/headless.cpp"
+                            ],
+                            "libraries": [
+                                "-lEGL",
+                                "-lGLESv2",
+                                '<!@(pkg-config --libs freetype2)',
+                                '-ljpeg',
+                                '-lpng',
+                                '-lavcodec',
+                                '-lavformat',
+                                '-lavutil',
+                                '-lswscale'
+                            ],
+                            "defines": [
+                                "HEADLESS"
+                            ],
+                            "include_dirs": [
+                                '<!@(pkg-config --cflags freetype2)'
+                            ],
+                            "cflags_cc": [
+                                # NAN weak reference warning (remove later)
+                                "-Wno-class-memaccess"
+                            ]
+                        }]
 		            ]
                 }],
 
@@ -0,0 +1,46 @@
+'use strict';
+
+const amino = require('../../main.js');
+
+//create instance
+const gfx = new amino.AminoGfx({
+    atlasPages: 2,       //atlas pages per font
+    atlasEvictFrames: 60 //evict pages not used for a second
+});
+
+gfx.start(function (err) {
+    if (err) {
+        console.log('Amino error: ' + err.message);
+        return;
+    }
+
+    const root = this.createGroup();
+    const text = this.createText().fontSize(120).y(200).fill('#ffffff');
+
+    root.add(text);
+    this.setRoot(root);
+
+    //new glyphs (fills the atlas pages)
+    let codepoint = 0x21;
+    let size = 40;
+
+    setInterval(() => {
+        let str = '';
+
+        for (let i = 0; i < 10; i++) {
+            str += String.fromCharCode(codepoint++);
+
+            if (codepoint > 0x24f) {
+                codepoint = 0x21;
+                size += 10;
+            }
+        }
+
+        text.fontSize(size).text(str);
+    }, 50);
+
+    //stats
+    setInterval(() => {
+        console.log('atlas: ' + JSON.stringify(gfx.getStats().atlas));
+    }, 1000);
+});
@@ -0,0 +1,42 @@
+'use strict';
+
+const amino = require('../../main.js');
+
+//create instance
+const gfx = new amino.AminoGfx();
+
+gfx.start(function (err) {
+    if (err) {
+        console.log('Amino error: ' + err.message);
+        return;
+    }
+
+    //dashboard: tiles with labels (Note: each layer is batched)
+    const root = this.createGroup();
+    const tiles = this.createGroup();
+    const labels = this.createGroup();
+    const cols = 20;
+    const rows = 15;
+    const w = this.w() / cols;
+    const h = this.h() / rows;
+
+    for (let y = 0; y < rows; y++) {
+        for (let x = 0; x < cols; x++) {
+            const rect = this.createRect().x(x * w + 1).y(y * h + 1).w(w - 2).h(h - 2).fill(((x + y) % 2) ? '#336699' : '#669933');
+            const text = this.createText().x(x * w + 4).y(y * h + h / 2).text('' + (y * cols + x)).fill('#ffffff');
+
+            tiles.add(rect);
+            labels.add(text);
+        }
+    }
+
+    root.add(tiles, labels);
+    this.setRoot(root);
+
+    //stats
+    setInterval(() => {
+        const stats = gfx.getStats();
+
+        console.log('draw calls: ' + stats.drawCalls + ' batched quads: ' + stats.batchedQuads);
+    }, 1000);
+});
@@ -0,0 +1,41 @@
+'use strict';
+
+const amino = require('../../main.js');
+
+//create instance
+const gfx = new amino.AminoGfx();
+
+gfx.start(function (err) {
+    if (err) {
+        console.log('Amino error: ' + err.message);
+        return;
+    }
+
+    //scrolling list (most rows off-screen)
+    const root = this.createGroup();
+    const list = this.createGroup().w(400).h(300).x(50).y(50).clipRect(true);
+    const rows = this.createGroup();
+    const rowH = 30;
+
+    for (let i = 0; i < 5000; i++) {
+        const row = this.createGroup().y(i * rowH);
+
+        row.add(this.createRect().w(400).h(rowH - 2).fill(i % 2 ? '#333333' : '#444444'));
+        row.add(this.createText().x(10).y(20).text('Row ' + i).fill('#ffffff'));
+        rows.add(row);
+    }
+
+    list.add(rows);
+    root.add(list);
+    this.setRoot(root);
+
+    //scroll
+    rows.y.anim().from(0).to(-5000 * rowH + 300).dur(60000).start();
+
+    //stats
+    setInterval(() => {
+        const stats = gfx.getStats();
+
+        console.log('culled nodes: ' + stats.culledNodes + ' draw calls: ' + stats.drawCalls);
+    }, 1000);
+});
@@ -0,0 +1,40 @@
+'use strict';
+
+const path = require('path');
+const os = require('os');
+const amino = require('../../main.js');
+
+//create instance
+const gfx = new amino.AminoGfx({
+    fontCache: os.tmpdir() //glyph atlas cache (second start restores the glyphs)
+});
+
+gfx.start(function (err) {
+    if (err) {
+        console.log('Amino error: ' + err.message);
+        return;
+    }
+
+    const root = this.createGroup();
+    let str = '';
+
+    for (let i = 0x21; i < 0x250; i++) {
+        str += String.fromCharCode(i);
+    }
+
+    const startTime = Date.now();
+    const text = this.createText().fontSize(24).x(10).y(40).w(this.w() - 20).wrap('word').text(str).fill('#ffffff');
+
+    root.add(text);
+    this.setRoot(root);
+
+    //wait for layout
+    text.lineNr.watch(() => {
+        console.log('glyphs ready: ' + (Date.now() - startTime) + ' ms (cache: ' + path.join(os.tmpdir(), '*.glyphs') + ')');
+    });
+
+    //stop (writes cache)
+    setTimeout(() => {
+        gfx.destroy();
+    }, 3000);
+});
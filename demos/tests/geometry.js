@@ -0,0 +1,56 @@
+'use strict';
+
+const amino = require('../../main.js');
+
+//create instance
+const gfx = new amino.AminoGfx();
+
+gfx.start(function (err) {
+    if (err) {
+        console.log('Amino error: ' + err.message);
+        return;
+    }
+
+    const root = this.createGroup();
+    const model = this.createModel().x(this.w() / 2).y(this.h() / 2);
+
+    root.add(model);
+    this.setRoot(root);
+
+    //triangle strip of quads (shared with the renderer)
+    const columns = 500;
+    const vertices = new Float32Array(columns * 6 * 3);
+    const step = this.w() / columns;
+
+    for (let i = 0; i < columns; i++) {
+        const x = (i - columns / 2) * step;
+        const quad = [
+            x, 0, 0,   x + step, 0, 0,   x, 10, 0,
+            x + step, 0, 0,   x + step, 10, 0,   x, 10, 0
+        ];
+
+        vertices.set(quad, i * 18);
+    }
+
+    model.vertices(vertices);
+
+    //modify a window of columns in place (only this range is uploaded)
+    let frame = 0;
+    const span = 50;
+
+    setInterval(() => {
+        const first = (frame * 5) % (columns - span);
+
+        for (let i = first; i < first + span; i++) {
+            const h = 10 + Math.abs(Math.sin((frame + i) / 10)) * 100;
+
+            //top vertices
+            vertices[i * 18 + 7] = h;
+            vertices[i * 18 + 13] = h;
+            vertices[i * 18 + 16] = h;
+        }
+
+        model.vertices.changed(first * 18, span * 18);
+        frame++;
+    }, 16);
+});
@@ -0,0 +1,51 @@
+'use strict';
+
+const amino = require('../../main.js');
+const fs = require('fs');
+
+//create instance
+const gfx = new amino.AminoGfx({
+    fixedTimestep: 1000 / 30 //30 fps animation steps
+});
+
+gfx.w(320);
+gfx.h(240);
+
+gfx.start(function (err) {
+    if (err) {
+        console.log('Amino error: ' + err.message);
+        return;
+    }
+
+    this.fill('#FF0000');
+
+    //scene
+    const root = this.createGroup();
+    const rect = this.createRect().w(100).h(100).fill('#0000FF');
+
+    root.add(rect);
+    this.setRoot(root);
+
+    rect.x.anim().from(0).to(220).dur(1000).start();
+
+    //write frame as PPM
+    this.readPixels((err, frame) => {
+        if (err) {
+            console.log('readPixels error: ' + err.message);
+            return;
+        }
+
+        const rgb = Buffer.alloc(frame.w * frame.h * 3);
+
+        for (let i = 0, j = 0; i < frame.data.length; i += 4, j += 3) {
+            rgb[j] = frame.data[i];
+            rgb[j + 1] = frame.data[i + 1];
+            rgb[j + 2] = frame.data[i + 2];
+        }
+
+        fs.writeFileSync('frame.ppm', Buffer.concat([ Buffer.from('P6\n' + frame.w + ' ' + frame.h + '\n255\n'), rgb ]));
+        console.log('written frame.ppm (' + frame.w + 'x' + frame.h + ')');
+
+        this.destroy();
+    });
+});
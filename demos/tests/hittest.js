@@ -0,0 +1,42 @@
+'use strict';
+
+const amino = require('../../main.js');
+
+//create instance
+const gfx = new amino.AminoGfx();
+
+gfx.start(function (err) {
+    if (err) {
+        console.log('Amino error: ' + err.message);
+        return;
+    }
+
+    //grid of rotated rects (partly clipped)
+    const root = this.createGroup();
+    const clip = this.createGroup().w(600).h(400).x(50).y(50).clipRect(true);
+    const size = 20;
+
+    for (let y = 0; y < 30; y++) {
+        for (let x = 0; x < 40; x++) {
+            const rect = this.createRect().w(size).h(size).x(x * size * 1.5).y(y * size * 1.5)
+                .originX(0.5).originY(0.5).rz((x + y) * 5).fill('#4488cc');
+
+            rect.id('rect-' + x + '-' + y);
+            clip.add(rect);
+        }
+    }
+
+    root.add(clip);
+    this.setRoot(root);
+
+    //query
+    setInterval(() => {
+        const x = Math.random() * gfx.w();
+        const y = Math.random() * gfx.h();
+        const start = process.hrtime();
+        const nodes = gfx.findNodesAtXY(amino.input.makePoint(x, y));
+        const diff = process.hrtime(start);
+
+        console.log('at ' + Math.round(x) + ',' + Math.round(y) + ': ' + nodes.map(node => node.id()).join(', ') + ' (' + (diff[1] / 1000).toFixed(1) + ' us)');
+    }, 500);
+});
@@ -0,0 +1,33 @@
+'use strict';
+
+const amino = require('../../main.js');
+
+//create instance
+const gfx = new amino.AminoGfx({
+    idleMode: true //skip rendering of unchanged frames
+});
+
+gfx.start(function (err) {
+    if (err) {
+        console.log('Amino error: ' + err.message);
+        return;
+    }
+
+    this.fill('#FF0000');
+
+    //change the scene every 5 seconds
+    const root = this.createGroup();
+    const rect = this.createRect().w(100).h(100).fill('#0000FF');
+
+    root.add(rect);
+    this.setRoot(root);
+
+    setInterval(() => {
+        rect.x(Math.random() * (this.w() - 100));
+    }, 5000);
+
+    //stats
+    setInterval(() => {
+        console.log('idle: ' + JSON.stringify(gfx.getStats().idle));
+    }, 1000);
+});
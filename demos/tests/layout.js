@@ -0,0 +1,48 @@
+'use strict';
+
+const amino = require('../../main.js');
+
+//create instance
+const gfx = new amino.AminoGfx({
+    layoutThreads: 2 //text layout workers (0: layout on rendering thread)
+});
+
+gfx.start(function (err) {
+    if (err) {
+        console.log('Amino error: ' + err.message);
+        return;
+    }
+
+    const root = this.createGroup();
+    const text = this.createText().fontSize(14).x(10).y(20).w(this.w() - 20).wrap('word').fill('#ffffff');
+    const spinner = this.createRect().w(50).h(50).x(this.w() - 80).y(this.h() - 80).fill('#ff0000');
+
+    root.add(text, spinner);
+    this.setRoot(root);
+
+    //animation (should not stutter)
+    spinner.rz.anim().from(0).to(360).dur(2000).loop(-1).start();
+
+    //large text updates
+    let count = 0;
+
+    setInterval(() => {
+        let str = '';
+
+        for (let i = 0; i < 400; i++) {
+            str += 'word' + (count + i) + ' ';
+        }
+
+        count++;
+        text.text(str);
+    }, 30);
+
+    //stats
+    setInterval(() => {
+        const phases = gfx.getStats().phases;
+
+        if (phases) {
+            console.log('updateTextNodes: ' + JSON.stringify(phases.updateTextNodes));
+        }
+    }, 1000);
+});
@@ -0,0 +1,38 @@
+'use strict';
+
+const amino = require('../../main.js');
+
+//create instance
+const gfx = new amino.AminoGfx();
+
+gfx.start(function (err) {
+    if (err) {
+        console.log('Amino error: ' + err.message);
+        return;
+    }
+
+    const root = this.createGroup();
+    const labels = [];
+
+    //same strings on many nodes
+    for (let i = 0; i < 50; i++) {
+        const label = this.createText().fontSize(20).x(20 + (i % 5) * 150).y(40 + Math.floor(i / 5) * 40).fill('#ffffff');
+
+        labels.push(label);
+        root.add(label);
+    }
+
+    this.setRoot(root);
+
+    //clock
+    setInterval(() => {
+        const str = new Date().toLocaleTimeString();
+
+        labels.forEach(label => label.text(str));
+    }, 100);
+
+    //stats
+    setInterval(() => {
+        console.log('layout cache: ' + JSON.stringify(gfx.getStats().layoutCache));
+    }, 1000);
+});
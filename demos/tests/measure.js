@@ -0,0 +1,47 @@
+'use strict';
+
+const amino = require('../../main.js');
+
+//create instance
+const gfx = new amino.AminoGfx();
+
+gfx.start(function (err) {
+    if (err) {
+        console.log('Amino error: ' + err.message);
+        return;
+    }
+
+    //default font
+    amino.fonts.getFont(null, function (err, font) {
+        if (err) {
+            console.log('could not load font: ' + err.message);
+            return;
+        }
+
+        //table cells
+        const texts = [];
+
+        for (let i = 0; i < 5000; i++) {
+            texts.push('Row ' + i + ': ' + (i * 1.25).toFixed(2));
+        }
+
+        //single calls
+        let startTime = Date.now();
+
+        texts.forEach(text => font.calcTextWidth(text, () => {}));
+
+        console.log('calcTextWidth(): ' + (Date.now() - startTime) + ' ms');
+
+        //batch
+        startTime = Date.now();
+
+        font.calcTextWidths(texts, function (err, widths) {
+            console.log('calcTextWidths(): ' + (Date.now() - startTime) + ' ms (' + widths.length + ' widths)');
+        });
+
+        //word wrap
+        font.calcTextWidths(['The quick brown fox jumps over the lazy dog.'], 150, function (err, res) {
+            console.log('wrapped: width=' + res.widths[0] + ' lines=' + res.lines[0] + ' breaks=' + Array.from(res.breaks));
+        });
+    });
+});
@@ -0,0 +1,40 @@
+'use strict';
+
+const amino = require('../../main.js');
+
+//create instance
+const gfx = new amino.AminoGfx();
+
+gfx.start(function (err) {
+    if (err) {
+        console.log('Amino error: ' + err.message);
+        return;
+    }
+
+    const root = this.createGroup();
+    const splash = this.createText().fontSize(30).x(20).y(50).text('Loading...').fill('#ffffff');
+
+    root.add(splash);
+    this.setRoot(root);
+
+    //default font
+    amino.fonts.getFont({ size: 24 }, (err, fontSize) => {
+        if (err) {
+            console.log('could not load font: ' + err.message);
+            return;
+        }
+
+        const startTime = Date.now();
+
+        //Latin-1 and Latin Extended-A
+        fontSize.preloadGlyphs([[0x20, 0x7E], [0xA0, 0x17F], '€'], (err, missing) => {
+            console.log('preloaded: ' + (Date.now() - startTime) + ' ms (missing: ' + missing + ')');
+
+            //no hitch
+            const text = this.createText().fontSize(24).x(20).y(100).text('Ærøskøbing Čeština Łódź €').fill('#ffffff');
+
+            splash.visible(false);
+            root.add(text);
+        });
+    });
+});
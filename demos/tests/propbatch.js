@@ -0,0 +1,55 @@
+'use strict';
+
+const amino = require('../../main.js');
+
+//create instance
+const gfx = new amino.AminoGfx();
+
+gfx.start(function (err) {
+    if (err) {
+        console.log('Amino error: ' + err.message);
+        return;
+    }
+
+    const root = this.createGroup();
+    const rects = [];
+
+    for (let i = 0; i < 500; i++) {
+        const rect = this.createRect().w(10).h(10).fill('#00ff00');
+
+        rects.push(rect);
+        root.add(rect);
+    }
+
+    this.setRoot(root);
+
+    //move all nodes (single native call per frame)
+    let frame = 0;
+    let total = 0;
+
+    setInterval(() => {
+        const startTime = process.hrtime();
+
+        amino.batch(() => {
+            rects.forEach((rect, i) => {
+                const angle = (frame + i) / 50;
+
+                rect.x(this.w() / 2 + Math.cos(angle) * i * 0.5).y(this.h() / 2 + Math.sin(angle) * i * 0.5);
+            });
+        });
+
+        const diff = process.hrtime(startTime);
+
+        total += diff[0] * 1e3 + diff[1] / 1e6;
+        frame++;
+
+        if (frame % 60 === 0) {
+            console.log('batch: ' + (total / 60).toFixed(3) + ' ms');
+            const stats = gfx.getStats();
+
+            console.log('async queue: ' + JSON.stringify(stats.asyncQueue));
+            console.log('update pool: ' + JSON.stringify(stats.updatePool));
+            total = 0;
+        }
+    }, 16);
+});
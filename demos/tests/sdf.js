@@ -0,0 +1,40 @@
+'use strict';
+
+const amino = require('../../main.js');
+
+//create instance
+const gfx = new amino.AminoGfx();
+
+gfx.start(function (err) {
+    if (err) {
+        console.log('Amino error: ' + err.message);
+        return;
+    }
+
+    const root = this.createGroup();
+
+    this.setRoot(root);
+
+    //bitmap font (one glyph set per size)
+    const bitmap = this.createText().text('Bitmap Text').fontSize(30).x(20).y(60).fill('#ffffff');
+
+    //signed distance field font (shared glyphs, any size)
+    const sdf = this.createText().text('SDF Text').sdf(true).fontSize(30).x(20).y(200).fill('#ffffff');
+
+    //outline & shadow
+    const fx = this.createText().text('Outline & Shadow').sdf(true).fontSize(50).x(20).y(320).fill('#ffff00');
+
+    fx.outline('#ff0000').outlineW(2);
+    fx.shadow('#000000').shadowOpacity(0.8).shadowX(4).shadowY(4).shadowBlur(3);
+
+    root.add(bitmap, sdf, fx);
+
+    //zoom
+    bitmap.sx.anim().from(1).to(4).dur(3000).loop(-1).autoreverse(true).start();
+    sdf.fontSize.anim().from(30).to(120).dur(3000).loop(-1).autoreverse(true).start();
+
+    //stats
+    setInterval(() => {
+        console.log('atlas: ' + JSON.stringify(gfx.getStats().atlas));
+    }, 1000);
+});
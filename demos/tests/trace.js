@@ -0,0 +1,32 @@
+'use strict';
+
+const amino = require('../../main.js');
+const fs = require('fs');
+
+const gfx = new amino.AminoGfx();
+
+gfx.start(function (err) {
+    if (err) {
+        console.log('Amino error: ' + err.message);
+        return;
+    }
+
+    this.fill('#FF0000');
+
+    //animated scene
+    const root = this.createGroup();
+    const rect = this.createRect().w(100).h(100).fill('#0000FF');
+
+    root.add(rect);
+    this.setRoot(root);
+
+    rect.x.anim().from(0).to(500).dur(1000).loop(-1).autoreverse(true).start();
+
+    //record 3 seconds (open in chrome://tracing or Perfetto)
+    this.startTrace();
+
+    setTimeout(() => {
+        fs.writeFileSync('trace.json', this.stopTrace());
+        console.log('written trace.json');
+    }, 3000);
+});
@@ -5,6 +5,9 @@ declare module "aminogfx-gl" {
         constructor(createParams?: {
             display?: 'HDMI-A-1'|'HDMI-A-2';
             resolution?: '1080p@60';
+            swapInterval?: number;
+            idleMode?: boolean; // skip rendering of unchanged frames
+            fixedTimestep?: number; // animation time per frame (ms)
         });
 
         x: Property<this>;
@@ -22,6 +25,11 @@ declare module "aminogfx-gl" {
         }
 
         setRoot(root: Group): void;
+        getTime(): number;
+        getStats(): any;
+        readPixels(cb: (err: any, frame: { w: number, h: number, data: Buffer }) => void): void;
+        startTrace(): void;
+        stopTrace(): string; // Chrome trace event JSON
         createGroup(): Group;
         createRect(): Rect;
         createImageView(): ImageView;
@@ -51,6 +59,8 @@ declare module "aminogfx-gl" {
             };
         };
     }
+    export function batch<T>(fn: () => T): T; // single native call for all property changes
+
     export module fonts {
         export function registerFont(font: Font): void;
     }
@@ -79,6 +89,7 @@ declare module "aminogfx-gl" {
         readonly: boolean;
         anim(props?: AnimParams): Anim;
         watch(cb: (val: T, prop: Property<O, T>, obj: O) => void, callNow?: boolean): O;
+        changed(start?: number, count?: number): O;
         curAnim?: Anim;
     }
 
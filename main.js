@@ -38,6 +38,107 @@ function getRequestHandler() {
 
 exports.getRequestHandler = getRequestHandler;
 
+//
+// Batched property updates
+//
+
+/**
+ * Property updates collected in a packed buffer.
+ *
+ * Record: object index, property id, value type, value (number, boolean or index of values).
+ */
+function PropertyBatch() {
+    this.records = new Float64Array(4 * 256);
+    this.count = 0;
+    this.objects = [];
+    this.objectIndex = new Map();
+    this.values = [];
+}
+
+/**
+ * Add a property update.
+ */
+PropertyBatch.prototype.add = function (obj, propId, value) {
+    //grow
+    const offset = this.count * 4;
+
+    if (offset + 4 > this.records.length) {
+        const records = new Float64Array(this.records.length * 2);
+
+        records.set(this.records);
+        this.records = records;
+    }
+
+    //object
+    let index = this.objectIndex.get(obj);
+
+    if (index === undefined) {
+        index = this.objects.length;
+        this.objects.push(obj);
+        this.objectIndex.set(obj, index);
+    }
+
+    //value
+    const records = this.records;
+
+    records[offset] = index;
+    records[offset + 1] = propId;
+
+    if (typeof value === 'number') {
+        records[offset + 2] = 0;
+        records[offset + 3] = value;
+    } else if (typeof value === 'boolean') {
+        records[offset + 2] = 1;
+        records[offset + 3] = value ? 1 : 0;
+    } else {
+        records[offset + 2] = 2;
+        records[offset + 3] = this.values.length;
+        this.values.push(value);
+    }
+
+    this.count++;
+};
+
+/**
+ * Pass all updates to the native side (single call).
+ */
+PropertyBatch.prototype.submit = function () {
+    if (this.count > 0) {
+        AminoGfx._propertiesUpdated(this.records, this.count, this.objects, this.values);
+    }
+
+    //reset (buffer is reused)
+    this.count = 0;
+    this.objects = [];
+    this.objectIndex.clear();
+    this.values = [];
+};
+
+const propertyBatch = new PropertyBatch();
+let batch = null;
+
+/**
+ * Run a function and pass all property changes to the native side at once.
+ *
+ * Nested calls are part of the outer batch. Returns the result of the function.
+ */
+function runBatch(fun) {
+    if (batch) {
+        return fun();
+    }
+
+    batch = propertyBatch;
+
+    try {
+        return fun();
+    } finally {
+        batch = null;
+        propertyBatch.submit();
+    }
+}
+
+exports.batch = runBatch;
+
 //
 //  AminoGfx
 //
@@ -107,6 +208,28 @@ function watchFill(value, prop, obj) {
     obj.b(color.b);
 }
 
+/**
+ * Outline color has changed.
+ */
+function watchOutline(value, prop, obj) {
+    const color = parseRGBString(value);
+
+    obj.outlineR(color.r);
+    obj.outlineG(color.g);
+    obj.outlineB(color.b);
+}
+
+/**
+ * Shadow color has changed.
+ */
+function watchShadow(value, prop, obj) {
+    const color = parseRGBString(value);
+
+    obj.shadowR(color.r);
+    obj.shadowG(color.g);
+    obj.shadowB(color.b);
+}
+
 /**
  * Convert RGB expression to object.
  *
@@ -368,6 +491,15 @@ AminoGfx.prototype.getStats = function () {
     return stats;
 };
 
+/**
+ * Read the pixels of the next rendered frame.
+ *
+ * Callback: (err, { w, h, data }) with RGBA data starting with the top row.
+ */
+AminoGfx.prototype.readPixels = function (callback) {
+    this._readPixels(callback);
+};
+
 /**
  * Find node with id.
  */
@@ -399,9 +531,51 @@ AminoGfx.prototype.find = function (id) {
  * Find a node at a certain position with an optional filter callback.
  */
 AminoGfx.prototype.findNodesAtXY = function (pt, filter) {
-    return findNodesAtXY(this.root, pt, filter, '');
+    //native index of the last frame
+    const hits = this._hitTest(pt.x, pt.y);
+
+    if (!hits) {
+        return findNodesAtXY(this.root, pt, filter, '');
+    }
+
+    const res = [];
+    const accepted = new Map();
+    const nodes = hits.nodes;
+    const coords = hits.coords;
+
+    for (let i = 0; i < nodes.length; i++) {
+        const node = nodes[i];
+
+        if (filter && !isAccepted(node, filter, accepted)) {
+            continue;
+        }
+
+        if (node.contains && node.contains(input.makePoint(coords[i * 2], coords[i * 2 + 1]))) {
+            res.push(node);
+        }
+    }
+
+    return res;
 };
 
+/**
+ * Check the filter on the node and all its parents (results are cached).
+ */
+function isAccepted(node, filter, accepted) {
+    if (!node) {
+        return true;
+    }
+
+    let res = accepted.get(node);
+
+    if (res === undefined) {
+        res = isAccepted(node.parent, filter, accepted) && !!filter(node);
+        accepted.set(node, res);
+    }
+
+    return res;
+}
+
 function findNodesAtXY(root, pt, filter, tab) {
     //verify
     if (!root || !root.visible()) {
@@ -446,7 +620,25 @@ function findNodesAtXY(root, pt, filter, tab) {
  * Find a node at a certain position.
  */
 AminoGfx.prototype.findNodeAtXY = function (x, y) {
-    return findNodeAtXY(this.root, x, y, '');
+    //native index of the last frame
+    const hits = this._hitTest(x, y);
+
+    if (!hits) {
+        return findNodeAtXY(this.root, x, y, '');
+    }
+
+    const nodes = hits.nodes;
+    const coords = hits.coords;
+
+    for (let i = 0; i < nodes.length; i++) {
+        const node = nodes[i];
+
+        if (node.contains && node.contains(input.makePoint(coords[i * 2], coords[i * 2 + 1]))) {
+            return node;
+        }
+    }
+
+    return null;
 };
 
 function findNodeAtXY(root, x, y, tab) {
@@ -1896,7 +2088,8 @@ AminoFonts.prototype.getFont = function (descr, callback) {
     }
 
     const name = descr.name || this.defaultFont.name;
-    const size = Math.round(descr.size || 20);
+    const sdf = !!descr.sdf;
+    const size = sdf ? descr.size || 20 : Math.round(descr.size || 20);
     let weight = descr.weight || 400;
     let style = descr.style || 'normal';
 
@@ -1963,12 +2156,12 @@ AminoFonts.prototype.getFont = function (descr, callback) {
     if (cached) {
         if (cached instanceof Promise) {
             cached.then(font => {
-                font.getSize(size, callback);
+                font.getSize(size, sdf, callback);
             }, err => {
                 callback(err);
             });
         } else {
-            cached.getSize(size, callback);
+            cached.getSize(size, sdf, callback);
         }
 
         return this;
@@ -2011,7 +2204,7 @@ AminoFonts.prototype.getFont = function (descr, callback) {
     promise.then(font => {
         this.cache[key] = font;
 
-        font.getSize(size, callback);
+        font.getSize(size, sdf, callback);
     }, err => {
         callback(err);
     });
@@ -2035,14 +2228,22 @@ AminoFont.prototype.init = function () {
 
 /**
  * Load font size.
+ *
+ * Signed distance field (sdf) sizes share their glyphs and support any size.
  */
-AminoFont.prototype.getSize = function (size, callback) {
+AminoFont.prototype.getSize = function (size, sdf, callback) {
+    if (typeof sdf === 'function') {
+        callback = sdf;
+        sdf = false;
+    }
+
     //check cache
-    let fontSize = this.fontSizes[size];
+    const key = sdf ? 'sdf/' + size : size;
+    let fontSize = this.fontSizes[key];
 
     if (!fontSize) {
-        fontSize = new AminoFonts.FontSize(this, size);
-        this.fontSizes[size] = fontSize;
+        fontSize = new AminoFonts.FontSize(this, size, sdf);
+        this.fontSizes[key] = fontSize;
     }
 
     callback(null, fontSize);
@@ -2061,6 +2262,55 @@ AminoFontSize.prototype.calcTextWidth = function (text, callback) {
     callback(null, this._calcTextWidth(text));
 };
 
+/**
+ * Calculate the widths of multiple texts (single native call).
+ *
+ * Returns a Float32Array of widths. If wrapWidth is set, the texts are word wrapped and an object is returned:
+ *
+ *  - widths: widest line of each text (Float32Array)
+ *  - lines: line count of each text (Uint32Array)
+ *  - breaks: character offsets of the new lines (Uint32Array; lines - 1 entries per text)
+ */
+AminoFontSize.prototype.calcTextWidths = function (texts, wrapWidth, callback) {
+    if (typeof wrapWidth === 'function') {
+        callback = wrapWidth;
+        wrapWidth = 0;
+    }
+
+    callback(null, this._calcTextWidths(texts, wrapWidth));
+};
+
+/**
+ * Load glyphs in advance (e.g. while a splash screen is shown).
+ *
+ * The characters are passed as string or as array of strings and [first, last] code point ranges. The glyphs are
+ * rendered on a worker thread. The callback is called once the atlas textures of all running instances were updated:
+ * (err, missing) with the number of glyphs which did not fit in the atlas.
+ */
+AminoFontSize.prototype.preloadGlyphs = function (chars, callback) {
+    if (Array.isArray(chars)) {
+        chars = chars.map(item => {
+            if (!Array.isArray(item)) {
+                return item;
+            }
+
+            //code point range
+            let str = '';
+
+            for (let cp = item[0]; cp <= item[1]; cp++) {
+                //skip control characters (no glyph) and surrogates
+                if (cp >= 0x20 && (cp < 0xD800 || cp > 0xDFFF)) {
+                    str += String.fromCodePoint(cp);
+                }
+            }
+
+            return str;
+        }).join('');
+    }
+
+    this._preloadGlyphs(chars, callback);
+};
+
 //
 // AminoGfxTexture
 //
@@ -2237,9 +2487,31 @@ Text.prototype.init = function () {
         maxLines: 0,
         lineNr: 1,
         lineW: 0,
+
+        //signed distance field font (scalable, outline & shadow support)
+        sdf: false,
+
+        //outline (sdf only)
+        outline: '#000000',
+        outlineR: 0,
+        outlineG: 0,
+        outlineB: 0,
+        outlineW: 0,
+
+        //shadow (sdf only)
+        shadow: '#000000',
+        shadowR: 0,
+        shadowG: 0,
+        shadowB: 0,
+        shadowOpacity: 0,
+        shadowX: 0,
+        shadowY: 0,
+        shadowBlur: 0
     });
 
     this.fill.watch(watchFill);
+    this.outline.watch(watchOutline);
+    this.shadow.watch(watchShadow);
 
     //TODO lines
     //TODO textHeight
@@ -2253,6 +2525,7 @@ Text.prototype.initDone = function () {
     this.fontName.watch(this.updateFont);
     this.fontWeight.watch(this.updateFont);
     this.fontSize.watch(this.updateFont);
+    this.sdf.watch(this.updateFont);
 };
 
 /**
@@ -2292,6 +2565,7 @@ Text.prototype.updateFont = function (val, prop, obj) {
         size: obj.fontSize(),
         weight: obj.fontWeight(),
         style: obj.fontStyle(),
+        sdf: obj.sdf()
     }, (err, font) => {
         //handle errors
         if (err) {
@@ -2299,7 +2573,8 @@ Text.prototype.updateFont = function (val, prop, obj) {
 
             //try default font
             fonts.getFont({
-                size: obj.fontSize()
+                size: obj.fontSize(),
+                sdf: obj.sdf()
             }, (err, font) => {
                 if (err) {
                     if (DEBUG_ERRORS) {
@@ -2636,7 +2911,11 @@ function makeProp(obj, name, val) {
         //native listener
         if (this.nativeListener && !nativeCall) {
             //prevent recursion in case of updates from native side
-            this.nativeListener(this.value, this.propId, obj);
+            if (batch) {
+                batch.add(obj, this.propId, this.value);
+            } else {
+                this.nativeListener(this.value, this.propId, obj);
+            }
         }
 
         //fire listeners
@@ -2647,6 +2926,33 @@ function makeProp(obj, name, val) {
         return obj;
     };
 
+    /**
+     * Typed array value was modified in place.
+     *
+     * Geometry arrays are shared with the renderer (not copied). The optional range (in elements) limits the upload
+     * to the modified values.
+     */
+    prop.changed = function (start, count) {
+        if (!this.nativeListener || !this.value) {
+            return obj;
+        }
+
+        if (batch) {
+            //whole array
+            batch.add(obj, this.propId, this.value);
+        } else if (start === undefined) {
+            this.nativeListener(this.value, this.propId, obj);
+        } else {
+            if (count === undefined) {
+                count = this.value.length - start;
+            }
+
+            this.nativeListener(this.value, this.propId, obj, start, count);
+        }
+
+        return obj;
+    };
+
     /**
      * Create animation.
      */
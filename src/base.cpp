@@ -1,6 +1,7 @@
 #include "base.h"
 
 #include <cwctype>
+#include <cstring>
 #include <algorithm>
 
 #include "renderer.h"
@@ -12,8 +13,15 @@
 #define DEBUG_FONT_UPDATES false
 
 #define MEASURE_FPS true
+#define MEASURE_PHASES true
 #define SHOW_RENDERER_ERRORS true
 
+//idle mode: max wait time (ms)
+#define IDLE_TIMEOUT 16
+
+//text layout worker threads (0: layout on rendering thread)
+#define LAYOUT_THREADS 2
+
 #define base_assert(x) _base_assert((void*)((x)), __LINE__)
 
 void _base_assert(void* x, int line) {
@@ -141,9 +149,22 @@ void AminoGfx::Init(Nan::ADDON_REGISTER_FUNCTION_ARGS_TYPE target, AminoJSObject
     //settings
     Nan::SetPrototypeMethod(tpl, "updatePerspective", UpdatePerspective);
 
+    // batched property updates
+    Nan::SetMethod(tpl, "_propertiesUpdated", AminoJSObject::PropertiesUpdated);
+
     // stats
     Nan::SetPrototypeMethod(tpl, "_getStats", GetStats);
 
+    // readback
+    Nan::SetPrototypeMethod(tpl, "_readPixels", ReadPixels);
+
+    // tracing
+    Nan::SetPrototypeMethod(tpl, "startTrace", StartTrace);
+    Nan::SetPrototypeMethod(tpl, "stopTrace", StopTrace);
+
+    // hit testing
+    Nan::SetPrototypeMethod(tpl, "_hitTest", HitTest);
+
     //global template instance
     v8::Local<v8::Function> func = Nan::GetFunction(tpl).ToLocalChecked();
 
@@ -267,6 +288,8 @@ void AminoGfx::initRenderer() {
     viewportH = propH->value;
     viewportChanged = true;
 
+    layoutThreads = LAYOUT_THREADS;
+
     //params
     if (!createParams.IsEmpty()) {
         v8::Local<v8::Object> obj = Nan::New(createParams);
@@ -281,7 +304,75 @@ void AminoGfx::initRenderer() {
                 swapInterval = Nan::To<v8::Integer>(swapIntervalValue).ToLocalChecked()->Value();
             }
         }
+
+        //idle mode
+        Nan::MaybeLocal<v8::Value> idleModeMaybe = Nan::Get(obj, Nan::New<v8::String>("idleMode").ToLocalChecked());
+
+        if (!idleModeMaybe.IsEmpty()) {
+            v8::Local<v8::Value> idleModeValue = idleModeMaybe.ToLocalChecked();
+
+            if (idleModeValue->IsBoolean()) {
+                idleMode = Nan::To<bool>(idleModeValue).FromJust();
+            }
+        }
+
+        //fixed timestep
+        Nan::MaybeLocal<v8::Value> fixedTimestepMaybe = Nan::Get(obj, Nan::New<v8::String>("fixedTimestep").ToLocalChecked());
+
+        if (!fixedTimestepMaybe.IsEmpty()) {
+            v8::Local<v8::Value> fixedTimestepValue = fixedTimestepMaybe.ToLocalChecked();
+
+            if (fixedTimestepValue->IsNumber()) {
+                fixedTimestep = Nan::To<v8::Number>(fixedTimestepValue).ToLocalChecked()->Value();
+            }
+        }
+
+        //font atlas pages (shared by all instances)
+        Nan::MaybeLocal<v8::Value> atlasPagesMaybe = Nan::Get(obj, Nan::New<v8::String>("atlasPages").ToLocalChecked());
+
+        if (!atlasPagesMaybe.IsEmpty()) {
+            v8::Local<v8::Value> atlasPagesValue = atlasPagesMaybe.ToLocalChecked();
+
+            if (atlasPagesValue->IsUint32()) {
+                AminoFont::setMaxAtlasPages(Nan::To<uint32_t>(atlasPagesValue).FromJust());
+            }
+        }
+
+        //font atlas eviction (frames)
+        Nan::MaybeLocal<v8::Value> atlasEvictFramesMaybe = Nan::Get(obj, Nan::New<v8::String>("atlasEvictFrames").ToLocalChecked());
+
+        if (!atlasEvictFramesMaybe.IsEmpty()) {
+            v8::Local<v8::Value> atlasEvictFramesValue = atlasEvictFramesMaybe.ToLocalChecked();
+
+            if (atlasEvictFramesValue->IsUint32()) {
+                AminoFont::setAtlasEvictFrames(Nan::To<uint32_t>(atlasEvictFramesValue).FromJust());
+            }
+        }
+
+        //text layout threads
+        Nan::MaybeLocal<v8::Value> layoutThreadsMaybe = Nan::Get(obj, Nan::New<v8::String>("layoutThreads").ToLocalChecked());
+
+        if (!layoutThreadsMaybe.IsEmpty()) {
+            v8::Local<v8::Value> layoutThreadsValue = layoutThreadsMaybe.ToLocalChecked();
+
+            if (layoutThreadsValue->IsUint32()) {
+                layoutThreads = Nan::To<uint32_t>(layoutThreadsValue).FromJust();
+            }
+        }
+
+        //glyph cache directory
+        Nan::MaybeLocal<v8::Value> fontCacheMaybe = Nan::Get(obj, Nan::New<v8::String>("fontCache").ToLocalChecked());
+
+        if (!fontCacheMaybe.IsEmpty()) {
+            v8::Local<v8::Value> fontCacheValue = fontCacheMaybe.ToLocalChecked();
+
+            if (fontCacheValue->IsString()) {
+                AminoFont::setCacheDir(AminoJSObject::toString(fontCacheValue));
+            }
+        }
     }
+
+    fixedTime = getTime();
 }
 
 /**
@@ -403,6 +494,8 @@ void AminoGfx::renderingThread(void *arg) {
 
     base_assert(gfx);
 
+    AminoTrace::setThreadName("rendering");
+
     //init
     gfx->initRendering();
 
@@ -431,6 +524,11 @@ void AminoGfx::renderingThread(void *arg) {
             gfx->rendererErrors += errors;
         }
 
+        //idle mode: block until the scene changes
+        if (gfx->frameSkipped) {
+            gfx->waitForSceneChange();
+        }
+
         if (DEBUG_THREADS) {
             printf("rendering: cycle done\n");
         }
@@ -464,20 +562,22 @@ void AminoGfx::measureRenderingEnd() {
     double time = getTime();
     double diff = time - fpsStart;
 
-    //cycle
-    fpsCount++;
+    //cycle (skipped frames are not counted)
+    if (!frameSkipped) {
+        fpsCount++;
 
-    double cycle = fpsCycleEnd - fpsCycleStart;
+        double cycle = fpsCycleEnd - fpsCycleStart;
 
-    if (fpsCycleMin == 0 || cycle < fpsCycleMin) {
-        fpsCycleMin = cycle;
-    }
+        if (fpsCycleMin == 0 || cycle < fpsCycleMin) {
+            fpsCycleMin = cycle;
+        }
 
-    if (cycle > fpsCycleMax) {
-        fpsCycleMax = cycle;
-    }
+        if (cycle > fpsCycleMax) {
+            fpsCycleMax = cycle;
+        }
 
-    fpsCycleAvg += cycle;
+        fpsCycleAvg += cycle;
+    }
 
     //output every second
     if (diff >= 1000) {
@@ -486,7 +586,7 @@ void AminoGfx::measureRenderingEnd() {
         lastCycleStart = fpsStart;
         lastCycleMax = fpsCycleMax;
         lastCycleMin = fpsCycleMin;
-        lastCycleAvg = fpsCycleAvg / fpsCount;
+        lastCycleAvg = fpsCount > 0 ? fpsCycleAvg / fpsCount : 0;
 
         //reset
         fpsStart = 0;
@@ -500,6 +600,117 @@ void AminoGfx::measureRenderingEnd() {
     }
 }
 
+/**
+ * Store the duration of a rendering phase.
+ *
+ * Returns the current time (start of the next phase).
+ */
+double AminoGfx::measurePhase(int phase, double startTime) {
+    double time = getTime();
+
+    phaseFrame[phase] = time - startTime;
+
+    return time;
+}
+
+/**
+ * Add the phase timings of the current frame to the rolling window.
+ *
+ * Note: called on rendering thread.
+ */
+void AminoGfx::addPhaseSample() {
+    double total = 0;
+
+    std::lock_guard<std::mutex> lock(phaseLock);
+
+    for (int i = 0; i < PHASE_COUNT; i++) {
+        phaseSamples[phaseSamplePos][i] = phaseFrame[i];
+        total += phaseFrame[i];
+    }
+
+    phaseTotals[phaseSamplePos] = total;
+
+    phaseSamplePos = (phaseSamplePos + 1) % PHASE_SAMPLES;
+
+    if (phaseSampleCount < PHASE_SAMPLES) {
+        phaseSampleCount++;
+    }
+}
+
+/**
+ * Add phase percentiles (p50/p95/p99/max) and the worst frame of the rolling window.
+ *
+ * Note: called on main thread.
+ */
+void AminoGfx::getPhaseStats(v8::Local<v8::Object> &obj) {
+    static const char *phaseNames[PHASE_COUNT] = { "processAsyncQueue", "processAnimations", "updateTextNodes", "renderScene", "renderingDone" };
+
+    //copy samples
+    std::vector<double> samples[PHASE_COUNT];
+    int worst = -1;
+    double worstTotal = 0;
+    double worstFrame[PHASE_COUNT];
+
+    phaseLock.lock();
+
+    int count = phaseSampleCount;
+
+    for (int i = 0; i < count; i++) {
+        for (int j = 0; j < PHASE_COUNT; j++) {
+            samples[j].push_back(phaseSamples[i][j]);
+        }
+
+        if (worst == -1 || phaseTotals[i] > worstTotal) {
+            worst = i;
+            worstTotal = phaseTotals[i];
+        }
+    }
+
+    if (worst != -1) {
+        for (int j = 0; j < PHASE_COUNT; j++) {
+            worstFrame[j] = phaseSamples[worst][j];
+        }
+    }
+
+    phaseLock.unlock();
+
+    if (count == 0) {
+        return;
+    }
+
+    //percentiles
+    v8::Local<v8::Object> phasesObj = Nan::New<v8::Object>();
+
+    Nan::Set(phasesObj, Nan::New("frames").ToLocalChecked(), Nan::New(count));
+
+    for (int i = 0; i < PHASE_COUNT; i++) {
+        std::vector<double> &values = samples[i];
+
+        std::sort(values.begin(), values.end());
+
+        v8::Local<v8::Object> phaseObj = Nan::New<v8::Object>();
+
+        Nan::Set(phaseObj, Nan::New("p50").ToLocalChecked(), Nan::New(values[(count - 1) * 50 / 100]));
+        Nan::Set(phaseObj, Nan::New("p95").ToLocalChecked(), Nan::New(values[(count - 1) * 95 / 100]));
+        Nan::Set(phaseObj, Nan::New("p99").ToLocalChecked(), Nan::New(values[(count - 1) * 99 / 100]));
+        Nan::Set(phaseObj, Nan::New("max").ToLocalChecked(), Nan::New(values[count - 1]));
+        Nan::Set(phasesObj, Nan::New(phaseNames[i]).ToLocalChecked(), phaseObj);
+    }
+
+    //worst frame
+    v8::Local<v8::Object> worstObj = Nan::New<v8::Object>();
+
+    Nan::Set(worstObj, Nan::New("total").ToLocalChecked(), Nan::New(worstTotal));
+
+    for (int i = 0; i < PHASE_COUNT; i++) {
+        Nan::Set(worstObj, Nan::New(phaseNames[i]).ToLocalChecked(), Nan::New(worstFrame[i]));
+    }
+
+    Nan::Set(phasesObj, Nan::New("worstFrame").ToLocalChecked(), worstObj);
+
+    Nan::Set(obj, Nan::New("phases").ToLocalChecked(), phasesObj);
+}
+
 /**
  * Start rendering in asynchronous thread.
  *
@@ -514,6 +725,9 @@ void AminoGfx::startRenderingThread() {
         printf("startRenderingThread()\n");
     }
 
+    //text layout workers
+    layoutPool.start(this, layoutThreads);
+
     //create rendering thread
     int res = uv_thread_create(&thread, renderingThread, this);
 
@@ -548,9 +762,14 @@ void AminoGfx::handleRenderEvents(uv_async_t *handle) {
     //create scope
     Nan::HandleScope scope;
 
+    TRACE_SCOPE("handleRenderEvents");
+
     gfx->handleJSUpdates();
     gfx->handleAsyncDeletes();
 
+    //new glyphs
+    AminoFont::saveCaches(false);
+
     //handle events
     gfx->handleSystemEvents();
 
@@ -571,10 +790,16 @@ void AminoGfx::stopRenderingThread() {
 
     threadRunning = false;
 
+    //wake up idle rendering thread
+    invalidateScene();
+
     int res = uv_thread_join(&thread);
 
     base_assert(res == 0);
 
+    //text layout workers
+    layoutPool.stop();
+
     //process remaining events
     res = uv_async_send(&asyncHandle);
 
@@ -605,6 +830,8 @@ void AminoGfx::initRendering() {
  * Render a scene (synchronous call).
  */
 void AminoGfx::render() {
+    frameSkipped = false;
+
     //context
     if (DEBUG_RENDERER) {
         printf("-> renderer: bindContext()\n");
@@ -616,13 +843,32 @@ void AminoGfx::render() {
 
     rendering = true;
 
+    TRACE_SCOPE("render");
+
     //updates
     if (DEBUG_RENDERER) {
         printf("-> renderer: handle updates\n");
     }
 
-    processAsyncQueue();
-    processAnimations();
+    double phaseTime = getTime();
+
+    {
+        TRACE_SCOPE("processAsyncQueue");
+
+        if (processAsyncQueue()) {
+            sceneDirty = true;
+        }
+    }
+
+    phaseTime = measurePhase(PHASE_ASYNC_QUEUE, phaseTime);
+
+    {
+        TRACE_SCOPE("processAnimations");
+
+        processAnimations();
+    }
+
+    phaseTime = measurePhase(PHASE_ANIMATIONS, phaseTime);
 
     //send signal to main thread to handle queues
     int res = uv_async_send(&asyncHandle);
@@ -630,30 +876,120 @@ void AminoGfx::render() {
     base_assert(res == 0);
 
     //update texts
-    updateTextNodes();
+    phaseTime = getTime();
+
+    {
+        TRACE_SCOPE("updateTextNodes");
+
+        AminoFont::nextFrame();
+        updateTextNodes();
+    }
+
+    phaseTime = measurePhase(PHASE_TEXT_UPDATES, phaseTime);
+
+    //idle mode: skip unchanged frames
+    if (idleMode) {
+        if (!sceneDirty && !viewportChanged) {
+            skippedFrames++;
+            frameSkipped = true;
+            rendering = false;
+
+            return;
+        }
+
+        //Note: reset before rendering (video textures mark the next frame)
+        sceneDirty = false;
+        renderedFrames++;
+    }
 
     //render scene (root node)
     if (DEBUG_RENDERER) {
         printf("-> renderer: renderScene()\n");
     }
 
-    renderScene();
+    {
+        TRACE_SCOPE("renderScene");
+
+        renderScene();
+    }
+
+    //readback
+    if (!readbacks.empty()) {
+        TRACE_SCOPE("readPixels");
+
+        readPixels();
+    }
+
+    phaseTime = measurePhase(PHASE_RENDER_SCENE, phaseTime);
 
     //done
-    fpsCycleEnd = getTime();
+    fpsCycleEnd = phaseTime;
 
     if (DEBUG_RENDERER) {
         printf("-> renderer: renderingDone()\n");
     }
 
-    renderingDone();
+    {
+        TRACE_SCOPE("renderingDone");
+
+        renderingDone();
+    }
+
     rendering = false;
 
+    measurePhase(PHASE_RENDERING_DONE, phaseTime);
+
+    if (MEASURE_PHASES) {
+        addPhaseSample();
+    }
+
     if (DEBUG_RENDERER) {
         printf("-> renderer: done\n");
     }
 }
 
+/**
+ * Mark the scene as modified and wake up an idle rendering thread.
+ *
+ * Note: can be called on any thread.
+ */
+void AminoGfx::invalidateScene() {
+    sceneDirty = true;
+
+    if (idleMode) {
+        std::lock_guard<std::mutex> lock(idleLock);
+
+        idleCondition.notify_one();
+    }
+}
+
+/**
+ * New async updates are available.
+ */
+void AminoGfx::asyncUpdatesAvailable() {
+    invalidateScene();
+}
+
+/**
+ * Block the rendering thread until the scene changes.
+ *
+ * Note: waits at most one frame to keep handling system events on the main thread.
+ */
+void AminoGfx::waitForSceneChange() {
+    if (DEBUG_BASE) {
+        base_assert(!isMainThread());
+    }
+
+    double startTime = getTime();
+    std::unique_lock<std::mutex> lock(idleLock);
+
+    idleCondition.wait_for(lock, std::chrono::milliseconds(IDLE_TIMEOUT), [this] {
+        return sceneDirty || !threadRunning;
+    });
+
+    idleTime += getTime() - startTime;
+}
+
 /**
  * Rendering thread aborted.
  */
@@ -675,14 +1011,22 @@ void AminoGfx::processAnimations() {
 
     // base_assert(res == 0);
 
-    double currentTime = getTime();
+    //fixed timestep: advance one step per cycle
+    if (fixedTimestep > 0) {
+        fixedTime += fixedTimestep;
+    }
+
+    double currentTime = getRenderTime();
     int count = animations.size();
 
     //debug timer
     //printf("timer timestamp: %f\n", currentTime);
 
+    //Note: paused, waiting or ended animations do not change the scene
     for (int i = 0; i < count; i++) {
-        animations[i]->update(currentTime);
+        if (animations[i]->update(currentTime)) {
+            sceneDirty = true;
+        }
     }
 
     animLock.unlock();
@@ -707,9 +1051,32 @@ NAN_METHOD(AminoGfx::ClearAnimations) {
  * Get current timer time (monotonic time, not current system time!).
  */
 NAN_METHOD(AminoGfx::GetTime) {
+    //instance call (supports fixed timestep)
+    if (info.This()->InternalFieldCount() > 0) {
+        AminoGfx *gfx = Nan::ObjectWrap::Unwrap<AminoGfx>(info.This());
+
+        if (gfx) {
+            info.GetReturnValue().Set(gfx->getRenderTime());
+            return;
+        }
+    }
+
     info.GetReturnValue().Set(getTime());
 }
 
+/**
+ * Get the animation time.
+ *
+ * Returns the simulated time if a fixed timestep is used.
+ */
+double AminoGfx::getRenderTime() {
+    if (fixedTimestep > 0) {
+        return fixedTime;
+    }
+
+    return getTime();
+}
+
 /**
  * Check if rendering scene right now.
  */
@@ -774,6 +1141,9 @@ void AminoGfx::destroyAminoGfx() {
     //stop thread
     stopRenderingThread();
 
+    //glyph cache
+    AminoFont::saveCaches(true);
+
     //bind context (to main thread)
     if (started) {
         started = false;
@@ -931,6 +1301,8 @@ void AminoGfx::setRoot(AminoGroup *group) {
     if (group) {
         group->retain();
     }
+
+    invalidateScene();
 }
 
 /**
@@ -950,6 +1322,215 @@ NAN_METHOD(AminoGfx::UpdatePerspective) {
     gfx->viewportChanged = true;
 }
 
+/**
+ * Read the pixels of the next rendered frame.
+ *
+ * Callback: (err, { w, h, data }) with RGBA data (top row first).
+ */
+NAN_METHOD(AminoGfx::ReadPixels) {
+    AminoGfx *gfx = Nan::ObjectWrap::Unwrap<AminoGfx>(info.This());
+
+    base_assert(gfx);
+
+    if (info.Length() < 1 || !info[0]->IsFunction()) {
+        Nan::ThrowTypeError("missing callback");
+        return;
+    }
+
+    if (gfx->destroyed || !gfx->started) {
+        Nan::ThrowError("not rendering");
+        return;
+    }
+
+    amino_readback_t *readback = new amino_readback_t();
+
+    readback->callback = new Nan::Callback(info[0].As<v8::Function>());
+    readback->data = NULL;
+    readback->w = 0;
+    readback->h = 0;
+
+    //switch to rendering thread
+    gfx->enqueueValueUpdate(0, readback, static_cast<asyncValueCallback>(&AminoGfx::readPixelsHandler));
+}
+
+/**
+ * Register readback request.
+ *
+ * Note: called on rendering thread.
+ */
+void AminoGfx::readPixelsHandler(AsyncValueUpdate *update, int state) {
+    if (state != AsyncValueUpdate::STATE_APPLY) {
+        return;
+    }
+
+    amino_readback_t *readback = (amino_readback_t *)update->data;
+
+    base_assert(readback);
+
+    readbacks.push_back(readback);
+}
+
+/**
+ * Read the current frame buffer and pass it to the main thread.
+ *
+ * Note: called on rendering thread after the scene was rendered.
+ */
+void AminoGfx::readPixels() {
+    int32_t w = viewportW;
+    int32_t h = viewportH;
+    std::size_t rowSize = w * 4;
+    std::size_t size = rowSize * h;
+    char *pixels = (char *)malloc(size);
+
+    base_assert(pixels);
+
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, w, h, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+
+    //flip vertically (OpenGL starts with the bottom row)
+    char *row = (char *)malloc(rowSize);
+
+    for (int32_t y = 0; y < h / 2; y++) {
+        char *top = pixels + y * rowSize;
+        char *bottom = pixels + (h - 1 - y) * rowSize;
+
+        memcpy(row, top, rowSize);
+        memcpy(top, bottom, rowSize);
+        memcpy(bottom, row, rowSize);
+    }
+
+    free(row);
+
+    //pass to main thread
+    std::size_t count = readbacks.size();
+
+    for (std::size_t i = 0; i < count; i++) {
+        amino_readback_t *readback = readbacks[i];
+
+        if (i == count - 1) {
+            readback->data = pixels;
+        } else {
+            readback->data = (char *)malloc(size);
+            memcpy(readback->data, pixels, size);
+        }
+
+        readback->w = w;
+        readback->h = h;
+
+        enqueueJSCallbackUpdate(static_cast<jsUpdateCallback>(&AminoGfx::readPixelsDone), NULL, readback);
+    }
+
+    readbacks.clear();
+}
+
+/**
+ * Call readback callback.
+ *
+ * Note: called on main thread.
+ */
+void AminoGfx::readPixelsDone(JSCallbackUpdate *update) {
+    amino_readback_t *readback = (amino_readback_t *)update->data;
+
+    base_assert(readback);
+
+    //create scope
+    Nan::HandleScope scope;
+
+    //result (Note: buffer takes ownership of the data)
+    v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+
+    Nan::Set(obj, Nan::New("w").ToLocalChecked(), Nan::New(readback->w));
+    Nan::Set(obj, Nan::New("h").ToLocalChecked(), Nan::New(readback->h));
+    Nan::Set(obj, Nan::New("data").ToLocalChecked(), Nan::NewBuffer(readback->data, readback->w * readback->h * 4).ToLocalChecked());
+
+    //call
+    int argc = 2;
+    v8::Local<v8::Value> argv[2] = { Nan::Null(), obj };
+
+    Nan::Call(*readback->callback, handle(), argc, argv);
+
+    delete readback->callback;
+    delete readback;
+}
+
+/**
+ * Start recording trace events.
+ */
+NAN_METHOD(AminoGfx::StartTrace) {
+    AminoTrace::setThreadName("main");
+    AminoTrace::start();
+}
+
+/**
+ * Stop recording trace events.
+ *
+ * Returns the Chrome trace event JSON (chrome://tracing or Perfetto).
+ */
+NAN_METHOD(AminoGfx::StopTrace) {
+    std::string json = AminoTrace::stop();
+
+    info.GetReturnValue().Set(Nan::New(json).ToLocalChecked());
+}
+
+/**
+ * Get the nodes at a screen position (topmost first).
+ *
+ * Returns undefined if no index of the last frame is available yet, otherwise the nodes and their local coordinates.
+ */
+NAN_METHOD(AminoGfx::HitTest) {
+    AminoGfx *gfx = Nan::ObjectWrap::Unwrap<AminoGfx>(info.This());
+
+    base_assert(gfx);
+
+    if (info.Length() < 2 || !info[0]->IsNumber() || !info[1]->IsNumber()) {
+        Nan::ThrowTypeError("x and y expected");
+        return;
+    }
+
+    GLfloat x = Nan::To<v8::Number>(info[0]).ToLocalChecked()->Value();
+    GLfloat y = Nan::To<v8::Number>(info[1]).ToLocalChecked()->Value();
+    std::vector<amino_hit_t> hits;
+
+    if (!gfx->hitIndex.isEnabled()) {
+        //record next frames
+        gfx->hitIndex.enable();
+        gfx->invalidateScene();
+
+        return;
+    }
+
+    if (!gfx->hitIndex.query(x, y, hits)) {
+        return;
+    }
+
+    //result
+    std::size_t count = hits.size();
+    v8::Local<v8::Array> nodes = Nan::New<v8::Array>(count);
+    v8::Local<v8::Float32Array> coords = v8::Float32Array::New(v8::ArrayBuffer::New(v8::Isolate::GetCurrent(), count * 2 * sizeof(float)), 0, count * 2);
+
+    for (std::size_t i = 0; i < count; i++) {
+        amino_hit_t &hit = hits[i];
+
+        Nan::Set(nodes, i, hit.node->handle());
+        Nan::Set(coords, i * 2, Nan::New<v8::Number>(hit.x));
+        Nan::Set(coords, i * 2 + 1, Nan::New<v8::Number>(hit.y));
+    }
+
+    v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+
+    Nan::Set(obj, Nan::New("nodes").ToLocalChecked(), nodes);
+    Nan::Set(obj, Nan::New("coords").ToLocalChecked(), coords);
+
+    info.GetReturnValue().Set(obj);
+}
+
+/**
+ * Get the hit test index.
+ */
+AminoHitIndex* AminoGfx::getHitIndex() {
+    return &hitIndex;
+}
+
 /**
  * Get runtime statistics.
  */
@@ -979,6 +1560,12 @@ void AminoGfx::getStats(v8::Local<v8::Object> &obj) {
     //textures
     Nan::Set(obj, Nan::New("textures").ToLocalChecked(), Nan::New(textureCount));
 
+    //font atlas (all fonts)
+    AminoFont::getAtlasStats(obj);
+
+    //text layouts (all instances)
+    AminoText::layoutCache.getStats(obj);
+
     //rendering performance (FPS)
     if (MEASURE_FPS && lastFPS) {
         //populate fps
@@ -992,11 +1579,33 @@ void AminoGfx::getStats(v8::Local<v8::Object> &obj) {
         Nan::Set(obj, Nan::New("fps").ToLocalChecked(), fpsObj);
     }
 
+    //rendering phases (ms)
+    if (MEASURE_PHASES) {
+        getPhaseStats(obj);
+    }
+
     //renderer
     if (SHOW_RENDERER_ERRORS) {
         Nan::Set(obj, Nan::New("errors").ToLocalChecked(), Nan::New(rendererErrors));
     }
 
+    if (renderer) {
+        //last frame
+        Nan::Set(obj, Nan::New("drawCalls").ToLocalChecked(), Nan::New(renderer->lastDrawCalls));
+        Nan::Set(obj, Nan::New("batchedQuads").ToLocalChecked(), Nan::New(renderer->lastBatchedQuads));
+        Nan::Set(obj, Nan::New("culledNodes").ToLocalChecked(), Nan::New(renderer->lastCulledNodes));
+    }
+
+    //idle mode
+    if (idleMode) {
+        v8::Local<v8::Object> idleObj = Nan::New<v8::Object>();
+
+        Nan::Set(idleObj, Nan::New("rendered").ToLocalChecked(), Nan::New(renderedFrames));
+        Nan::Set(idleObj, Nan::New("skipped").ToLocalChecked(), Nan::New(skippedFrames));
+        Nan::Set(idleObj, Nan::New("idleTime").ToLocalChecked(), Nan::New(idleTime));
+        Nan::Set(obj, Nan::New("idle").ToLocalChecked(), idleObj);
+    }
+
     //base class
     AminoJSEventObject::getStats(obj);
 }
@@ -1228,14 +1837,37 @@ void AminoGfx::textUpdateNeeded(AminoText *text) {
 }
 
 /**
- * Update all modified text nodes.
+ * Drop the queued layouts of a text.
+ *
+ * Note: called before the text is destroyed.
  */
-void AminoGfx::updateTextNodes() {
-    std::size_t count = textUpdates.size();
+void AminoGfx::cancelTextLayout(AminoText *text) {
+    layoutPool.cancel(text);
+}
 
-    if (count == 0) {
-        return;
+/**
+ * Queue the texts of the scene whose glyphs were evicted from the atlas.
+ */
+void AminoGfx::queueEvictedTexts(AminoNode *node) {
+    if (node->type == TEXT) {
+        AminoText *text = static_cast<AminoText *>(node);
+
+        if (text->hasEvictedGlyphs()) {
+            textUpdateNeeded(text);
+        }
+    } else if (node->type == GROUP) {
+        for (auto const &child : static_cast<AminoGroup *>(node)->children) {
+            queueEvictedTexts(child);
+        }
     }
+}
+
+/**
+ * Update all modified text nodes.
+ *
+ * Layouts are created by worker threads and swapped in as soon as they are done.
+ */
+void AminoGfx::updateTextNodes() {
     if (DEBUG_BASE) {
         base_assert(!isMainThread());
     }
@@ -1245,34 +1877,74 @@ void AminoGfx::updateTextNodes() {
     double startTime = getTime(), diff;
 #endif
 
-    //layout modified texts
-    std::vector<AminoText *> textureUpdates;
+    std::vector<texture_atlas_t *> atlasUpdates;
 
-    for (std::size_t i = 0; i < count; i++) {
-        AminoText *item = textUpdates[i];
+    //texts with evicted glyphs (laid out again before rendering)
+    uint32_t evictions = AminoFont::getAtlasEvictions();
 
-        if (item->layoutText()) {
-            //find texture
-            std::size_t textureCount = textureUpdates.size();
-            GLuint textureId = item->getTextureId();
-            bool found = false;
+    if (evictions != textEvictions) {
+        textEvictions = evictions;
 
-            for (std::size_t j = 0; j < textureCount; j++) {
-                AminoText *item2 = textureUpdates[j];
+        if (root) {
+            queueEvictedTexts(root);
+        }
+    }
 
-                if (item2->getTextureId() == textureId) {
-                    found = true;
-                    break;
-                }
+    //collect atlas pages
+    auto addAtlasUpdates = [&atlasUpdates](AminoText *item) {
+        for (auto const &page : item->pages) {
+            texture_atlas_t *atlas = page.page->atlas;
+
+            if (std::find(atlasUpdates.begin(), atlasUpdates.end(), atlas) == atlasUpdates.end()) {
+                atlasUpdates.push_back(atlas);
             }
+        }
+    };
+
+    if (layoutPool.isRunning()) {
+        //queue modified texts
+        for (auto const &item : textUpdates) {
+            amino_text_layout_t *layout = item->createLayout();
 
-            if (!found) {
-                textureUpdates.push_back(item);
+            if (layout) {
+                layoutPool.add(layout);
+            }
+        }
+
+        //swap in finished layouts
+        std::vector<amino_text_layout_t *> layouts;
+
+        layoutPool.beginSwap(layouts);
+
+        for (auto const &layout : layouts) {
+            AminoText *item = layout->text;
+
+            //skip outdated layouts
+            if (layout->generation > item->appliedGeneration && item->applyLayout(layout)) {
+                addAtlasUpdates(item);
+            }
+
+            delete layout;
+        }
+
+        layoutPool.endSwap();
+
+        if (!layouts.empty()) {
+            sceneDirty = true;
+        }
+    } else {
+        //layout modified texts
+        for (auto const &item : textUpdates) {
+            if (item->layoutText()) {
+                addAtlasUpdates(item);
             }
         }
     }
 
-    textUpdates.clear();
+    if (!textUpdates.empty()) {
+        sceneDirty = true;
+        textUpdates.clear();
+    }
 
 #if (DEBUG_FONT_PERFORMANCE == 1)
     //debug
@@ -1283,7 +1955,7 @@ void AminoGfx::updateTextNodes() {
 #endif
 
     //update textures
-    std::size_t textureCount = textureUpdates.size();
+    std::size_t textureCount = atlasUpdates.size();
 
 #if (DEBUG_FONT_PERFORMANCE == 1)
     //debug
@@ -1291,12 +1963,11 @@ void AminoGfx::updateTextNodes() {
 #endif
 
     for (std::size_t i = 0; i < textureCount; i++) {
-        AminoText *item = textureUpdates[i];
+        texture_atlas_t *atlas = atlasUpdates[i];
 
-        item->updateTexture();
-        //inform other amino instances to update shared texture
-        texture_atlas_t *atlas = item->fontSize->fontTexture->atlas;
+        uploadAtlasTexture(atlas);
 
+        //inform other amino instances to update shared texture
         atlasTextureHasChanged(atlas);
     }
 
@@ -1351,7 +2022,7 @@ void AminoGfx::updateAtlasTextureHandler(AsyncValueUpdate *update, int state) {
 
     texture_atlas_t *atlas = (texture_atlas_t *)update->data;
 
-    AminoText::updateTextureFromAtlas(update->valueUint32, atlas);
+    uploadAtlasTexture(atlas);
 }
 
 /**
@@ -1365,6 +2036,17 @@ amino_atlas_t AminoGfx::getAtlasTexture(texture_atlas_t *atlas, bool createIfMis
     return renderer->getAtlasTexture(atlas, createIfMissing, newTexture);
 }
 
+/**
+ * Upload the modified parts of an atlas to its texture.
+ *
+ * Note: has to be called on OpenGL thread.
+ */
+void AminoGfx::uploadAtlasTexture(texture_atlas_t *atlas) {
+    base_assert(renderer);
+
+    renderer->uploadAtlasTexture(atlas);
+}
+
 /**
  * A new texture was created.
  */
@@ -1383,6 +2065,51 @@ void AminoGfx::updateAtlasTextures(texture_atlas_t *atlas) {
     }
 }
 
+/**
+ * Create and upload the atlas textures of preloaded glyphs in all instances.
+ *
+ * Note: called on main thread.
+ */
+void AminoGfx::preloadAtlasTextures(amino_glyph_preload_t *preload) {
+    //Note: held until all instances were queued
+    preload->pending = 1;
+
+    for (auto const &item : instances) {
+        if (!item->started || preload->atlases.empty()) {
+            continue;
+        }
+
+        //switch to rendering thread (Note: done when the update is freed, even if it was dropped)
+        preload->pending++;
+        item->enqueueValueUpdate(0, preload, static_cast<asyncValueCallback>(&AminoGfx::preloadAtlasTexturesHandler));
+    }
+
+    AminoFontSize::preloadDone(preload);
+}
+
+/**
+ * Create and upload the atlas textures.
+ *
+ * Note: applied on rendering thread, freed on main thread.
+ */
+void AminoGfx::preloadAtlasTexturesHandler(AsyncValueUpdate *update, int state) {
+    amino_glyph_preload_t *preload = (amino_glyph_preload_t *)update->data;
+
+    base_assert(preload);
+
+    if (state == AsyncValueUpdate::STATE_APPLY) {
+        for (auto const &atlas : preload->atlases) {
+            bool newTexture;
+
+            getAtlasTexture(atlas, true, newTexture);
+            uploadAtlasTexture(atlas);
+        }
+    } else if (state == AsyncValueUpdate::STATE_DELETE) {
+        //uploaded or dropped (instance destroyed)
+        AminoFontSize::preloadDone(preload);
+    }
+}
+
 //static initializers
 int AminoGfx::instanceCount = 0;
 std::vector<AminoGfx *> AminoGfx::instances;
@@ -1500,7 +2227,7 @@ AminoJSObject* AminoTextFactory::create() {
 //
 
 /**
- * Update texture.
+ * Update textures (all atlas pages of the text).
  */
 void AminoText::updateTexture() {
     if (DEBUG_FONT_UPDATES) {
@@ -1509,21 +2236,19 @@ void AminoText::updateTexture() {
         printf("-> update font texture: %s\n", info.c_str());
     }
 
-    base_assert(texture.textureId != INVALID_TEXTURE);
-    base_assert(fontSize);
-    base_assert(fontSize->fontTexture);
-
-    texture_atlas_t *atlas = fontSize->fontTexture->atlas;
+    for (auto const &page : pages) {
+        base_assert(page.textureId != INVALID_TEXTURE);
 
-    base_assert(atlas);
-
-    updateTextureFromAtlas(texture.textureId, atlas);
+        getAminoGfx()->uploadAtlasTexture(page.page->atlas);
+    }
 }
 
 /**
  * Update texture from atlas.
+ *
+ * Only rows modified since the last upload (version) are transferred.
  */
-void AminoText::updateTextureFromAtlas(GLuint textureId, texture_atlas_t *atlas) {
+void AminoText::updateTextureFromAtlas(GLuint textureId, texture_atlas_t *atlas, uint32_t &version) {
     //update texture
     if (DEBUG_BASE) {
         printf("-> updateTexture()\n");
@@ -1562,32 +2287,111 @@ void AminoText::updateTextureFromAtlas(GLuint textureId, texture_atlas_t *atlas)
         printf("\n");
     }
 
+    if (version == atlas->version) {
+        //up to date
+        return;
+    }
+
     glBindTexture(GL_TEXTURE_2D, textureId);
 
-    //Note: glTexSubImage2D() would probably be faster
+    //Note: not supported so far
+    GLenum format = atlas->depth == 3 ? GL_RGB:GL_ALPHA;
+
+    if (version == 0) {
+        //allocate & upload all
+        glTexImage2D(GL_TEXTURE_2D, 0, format, atlas->width, atlas->height, 0, format, GL_UNSIGNED_BYTE, atlas->data);
+    } else {
+        //modified rows (full width; no GL_UNPACK_ROW_LENGTH on OpenGL ES 2.0)
+        size_t y = 0;
+        size_t h;
 
-    if (atlas->depth == 1) {
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, atlas->width, atlas->height, 0, GL_ALPHA, GL_UNSIGNED_BYTE, atlas->data);
-    } else if (atlas->depth == 3) {
-        //Note: not supported so far
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, atlas->width, atlas->height, 0, GL_RGB, GL_UNSIGNED_BYTE, atlas->data);
+        while (texture_atlas_get_dirty_rows(atlas, version, &y, &h)) {
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, y, atlas->width, h, format, GL_UNSIGNED_BYTE, atlas->data + y * atlas->width * atlas->depth);
+            y += h;
+        }
     }
 
+    version = atlas->version;
+
     //printf("font texture updated\n");
     //printf("updateTexture() done\n");
 }
 
 /**
- * Get the font texture.
+ * Check if glyphs of the text were evicted from the atlas.
+ *
+ * Note: the text has to be laid out again.
  */
-GLuint AminoText::getTextureId() {
-    return texture.textureId;
+bool AminoText::hasEvictedGlyphs() {
+    for (auto const &page : pages) {
+        if (page.evictions != page.page->evictions.load()) {
+            return true;
+        }
+    }
+
+    return false;
 }
 
 /**
- * Render text to vertices.
+ * Mark the atlas pages as used in the current frame.
  */
-void AminoText::addTextGlyphs(vertex_buffer_t *buffer, texture_font_t *font, const char *text, vec2 *pen, int wrap, int width, int *lineNr, int maxLines, float *lineW) {
+void AminoText::markPagesUsed() {
+    uint32_t frame = AminoFont::getFrame();
+
+    for (auto const &page : pages) {
+        page.page->lastUsed = frame;
+    }
+}
+
+/**
+ * Get the index of an atlas page (added if missing).
+ *
+ * Note: glyphLock of the font has to be locked.
+ */
+uint16_t AminoText::getPageIndex(amino_text_layout_t *layout, texture_atlas_t *atlas) {
+    std::vector<amino_text_page_t> &pages = layout->pages;
+    std::size_t count = pages.size();
+
+    for (std::size_t i = 0; i < count; i++) {
+        if (pages[i].page->atlas == atlas) {
+            return i;
+        }
+    }
+
+    amino_atlas_page_t *page = layout->font->getAtlasPage(atlas);
+
+    base_assert(page);
+
+    //used by layout (prevents eviction in this frame)
+    page->lastUsed = AminoFont::getFrame();
+
+    amino_text_page_t item;
+
+    item.page = page;
+    item.textureId = INVALID_TEXTURE;
+    item.evictions = page->evictions;
+
+    pages.push_back(item);
+
+    return count;
+}
+
+/**
+ * Render text to vertices.
+ *
+ * Note: glyphLock of the font has to be locked.
+ */
+void AminoText::addTextGlyphs(amino_text_layout_t *layout, vec2 *pen) {
+    vertex_buffer_t *buffer = layout->buffer;
+    texture_font_t *font = layout->fontTexture;
+    const char *text = layout->str.c_str();
+    int wrap = layout->wrap;
+    int width = layout->width;
+    int maxLines = layout->maxLines;
+    int *lineNr = &layout->lineNr;
+    float *lineW = &layout->lineW;
+    std::vector<uint16_t> &glyphPages = layout->glyphPages;
+
     //see https://github.com/rougier/freetype-gl/blob/master/demos/glyph.c
     size_t len = utf8_strlen(text);
 
@@ -1597,6 +2401,8 @@ void AminoText::addTextGlyphs(vertex_buffer_t *buffer, texture_font_t *font, con
     size_t lineStart = 0; //start of current line
     size_t linePos = 0; //character pos current line
     float penXStart = pen->x;
+    float scale = layout->scale; //SDF fonts
+    float lineHeight = font->height * scale;
 
     //debug
     //printf("addTextGlyphs: wrap=%i width=%i\n", wrap, width);
@@ -1618,7 +2424,7 @@ void AminoText::addTextGlyphs(vertex_buffer_t *buffer, texture_font_t *font, con
             int kerning = 0;
 
             if (linePos > 0) {
-                kerning = texture_glyph_get_kerning(glyph, lastTextPos);
+                kerning = texture_font_get_kerning(font, glyph, lastTextPos) * scale;
             }
 
             //wrap
@@ -1635,7 +2441,7 @@ void AminoText::addTextGlyphs(vertex_buffer_t *buffer, texture_font_t *font, con
             }
 
             if (wrap != AminoText::WRAP_NONE) {
-                if (pen->x + kerning + glyph->offset_x + glyph->width > width) {
+                if (pen->x + kerning + (glyph->offset_x + glyph->width) * scale > width) {
                     //have to wrap
 
                     //next line
@@ -1684,6 +2490,7 @@ void AminoText::addTextGlyphs(vertex_buffer_t *buffer, texture_font_t *font, con
 
                         //remove white space
                         vertex_buffer_erase(buffer, start);
+                        glyphPages.erase(glyphPages.begin() + start);
                         count--;
 
                         //update existing glyphs
@@ -1708,7 +2515,7 @@ void AminoText::addTextGlyphs(vertex_buffer_t *buffer, texture_font_t *font, con
 
                             for (size_t k = 0; k < vcount; k++) {
                                 vertices->x -= xOffset;
-                                vertices->y -= font->height; //inverse coordinates
+                                vertices->y -= lineHeight; //inverse coordinates
 
                                 vertices++;
                             }
@@ -1728,6 +2535,8 @@ void AminoText::addTextGlyphs(vertex_buffer_t *buffer, texture_font_t *font, con
                             for (size_t j = start; j < count; j++) {
                                 vertex_buffer_erase(buffer, start);
                             }
+
+                            glyphPages.erase(glyphPages.begin() + start, glyphPages.end());
                         }
                     }
                 }
@@ -1752,7 +2561,7 @@ void AminoText::addTextGlyphs(vertex_buffer_t *buffer, texture_font_t *font, con
                     (*lineNr)++;
                 }
 
-                pen->y -= font->height; //inverse coordinates
+                pen->y -= lineHeight; //inverse coordinates
             }
 
             if (skip) {
@@ -1764,15 +2573,15 @@ void AminoText::addTextGlyphs(vertex_buffer_t *buffer, texture_font_t *font, con
                 pen->x += kerning;
 
                 //glyph position
-                float x0  = pen->x + glyph->offset_x;
-                float y0  = pen->y + glyph->offset_y;
-                float x1  = x0 + glyph->width;
-                float y1  = y0 - glyph->height;
+                float x0  = pen->x + glyph->offset_x * scale;
+                float y0  = pen->y + glyph->offset_y * scale;
+                float x1  = x0 + glyph->width * scale;
+                float y1  = y0 - glyph->height * scale;
                 float s0 = glyph->s0;
                 float t0 = glyph->t0;
                 float s1 = glyph->s1;
                 float t1 = glyph->t1;
-                float advance = glyph->advance_x;
+                float advance = glyph->advance_x * scale;
 
                 //skip special characters
                 if (glyph->codepoint == 0x9d) {
@@ -1790,6 +2599,7 @@ void AminoText::addTextGlyphs(vertex_buffer_t *buffer, texture_font_t *font, con
 
                 //append
                 vertex_buffer_push_back(buffer, vertices, 4, indices, 6);
+                glyphPages.push_back(getPageIndex(layout, glyph->atlas));
                 linePos++;
 
                 //next
@@ -1827,71 +2637,178 @@ void AminoText::addTextGlyphs(vertex_buffer_t *buffer, texture_font_t *font, con
 }
 
 /**
- * Update the rendered text.
+ * Update the rendered text (synchronous call).
  *
  * Returns true if texture has changed and must be updated.
  */
 bool AminoText::layoutText() {
     //printf("layoutText()\n");
 
-    if (!fontSize) {
+    amino_text_layout_t *layout = createLayout();
+
+    if (!layout) {
         //printf("-> no font\n");
 
         return false;
     }
 
-    if (DEBUG_FONT_UPDATES) {
-        printf("->layoutText() render text (%s)\n", fontSize->font->fontName.c_str());
-    }
+    runLayout(layout);
 
-    //Note: FreeType glyph code is not thread-safe, using lock to prevent crash on macOS if multiple AminoGfx instances are active
-    uv_mutex_lock(&freeTypeMutex);
+    bool glyphsChanged = applyLayout(layout);
+
+    delete layout;
+
+    return glyphsChanged;
+}
+
+/**
+ * Create a layout of the current text values.
+ *
+ * Note: called on rendering thread.
+ */
+amino_text_layout_t *AminoText::createLayout() {
+    if (!fontSize) {
+        return NULL;
+    }
 
-    //create texture (needed in next calls)
     base_assert(fontSize->fontTexture);
 
-    texture_atlas_t *atlas = fontSize->fontTexture->atlas;
-    bool newTexture;
+    amino_text_layout_t *layout = new amino_text_layout_t();
 
-    base_assert(atlas);
-    base_assert(atlas->depth == 1);
+    layout->text = this;
+    layout->generation = ++layoutGeneration;
+    layout->font = fontSize->font;
+    layout->fontTexture = fontSize->fontTexture;
+    layout->scale = fontSize->scale;
+    layout->sdf = fontSize->sdf;
+    layout->str = propText->value;
+    layout->wrap = wrap;
+    layout->width = propW->value;
+    layout->maxLines = propMaxLines->value;
 
-    if (texture.textureId == INVALID_TEXTURE) {
-        //create or use existing texture (for atlas)
-        texture = getAminoGfx()->getAtlasTexture(atlas, true, newTexture);
+    return layout;
+}
 
-        base_assert(texture.textureId != INVALID_TEXTURE);
+/**
+ * Rasterize the glyphs and create the vertices of a layout.
+ *
+ * Note: called on any thread (only the font is locked).
+ */
+void AminoText::runLayout(amino_text_layout_t *layout) {
+    if (DEBUG_FONT_UPDATES) {
+        printf("->layoutText() render text (%s)\n", layout->font->fontName.c_str());
     }
 
-    //render text
-    if (buffer) {
-        vertex_buffer_clear(buffer);
-    } else {
-        //vertex & texture coordinates
-        buffer = vertex_buffer_new("pos:3f,texCoord:2f");
+    //Note: FreeType glyph code is not thread-safe, using lock per font (shared atlas pages)
+    std::lock_guard<std::mutex> lock(layout->font->glyphLock);
+
+    //vertex & texture coordinates
+    layout->buffer = vertex_buffer_new("pos:3f,texCoord:2f");
+
+    //shared layout
+    if (layoutCache.get(layout)) {
+        return;
     }
 
-    texture_font_t *fontTexture = fontSize->fontTexture;
-    size_t lastGlyphCount = fontTexture->glyphs->size;
+    //Note: new glyphs are stored in the current atlas page
+    texture_font_t *fontTexture = layout->fontTexture;
+    texture_atlas_t *lastAtlas = fontTexture->atlas;
+    uint32_t lastVersion = lastAtlas->version;
 
-    base_assert(fontTexture);
+    base_assert(lastAtlas->depth == 1);
 
     vec2 pen;
 
     pen.x = 0;
     pen.y = 0;
 
-    //Note: consider using async task to avoid performance issues
-    addTextGlyphs(buffer, fontTexture, propText->value.c_str(), &pen, wrap, propW->value, &lineNr, propMaxLines->value, &lineW);
+    addTextGlyphs(layout, &pen);
+
+    //bounding box
+    vertex_t *vertices = (vertex_t *)layout->buffer->vertices->items;
+    std::size_t count = layout->buffer->vertices->size;
+    GLfloat *bounds = layout->bounds;
+
+    for (std::size_t i = 0; i < count; i++) {
+        vertex_t *v = vertices + i;
+
+        if (i == 0 || v->x < bounds[0]) {
+            bounds[0] = v->x;
+        }
+
+        if (i == 0 || v->x > bounds[2]) {
+            bounds[2] = v->x;
+        }
+
+        if (i == 0 || v->y < bounds[1]) {
+            bounds[1] = v->y;
+        }
+
+        if (i == 0 || v->y > bounds[3]) {
+            bounds[3] = v->y;
+        }
+    }
 
     if (DEBUG_BASE) {
         printf("-> layoutText() done\n");
     }
 
-    size_t newGlyphCount = fontTexture->glyphs->size;
-    bool glyphsChanged = lastGlyphCount != newGlyphCount || (newTexture && newGlyphCount > 0);
+    layout->glyphsChanged = fontTexture->atlas != lastAtlas || fontTexture->atlas->version != lastVersion;
 
-    uv_mutex_unlock(&freeTypeMutex);
+    layoutCache.put(layout);
+}
+
+AminoLayoutCache AminoText::layoutCache;
+
+/**
+ * Swap in the vertices of a layout.
+ *
+ * Returns true if texture has changed and must be updated.
+ *
+ * Note: called on rendering thread.
+ */
+bool AminoText::applyLayout(amino_text_layout_t *layout) {
+    bool glyphsChanged = layout->glyphsChanged;
+
+    //vertices (reusing the OpenGL buffers)
+    if (buffer) {
+        layout->buffer->vertices_id = buffer->vertices_id;
+        layout->buffer->indices_id = buffer->indices_id;
+        layout->buffer->GPU_vsize = buffer->GPU_vsize;
+        layout->buffer->GPU_isize = buffer->GPU_isize;
+
+        buffer->vertices_id = 0;
+        buffer->indices_id = 0;
+
+        vertex_buffer_delete(buffer);
+    }
+
+    buffer = layout->buffer;
+    layout->buffer = NULL;
+
+    pages.swap(layout->pages);
+    glyphPages.swap(layout->glyphPages);
+    std::memcpy(bounds, layout->bounds, sizeof bounds);
+
+    layoutFont = layout->fontTexture;
+    layoutScale = layout->scale;
+    layoutSdf = layout->sdf;
+    lineNr = layout->lineNr;
+    lineW = layout->lineW;
+    appliedGeneration = layout->generation;
+
+    //create or use existing textures (for atlas pages)
+    for (auto &page : pages) {
+        bool newTexture;
+
+        page.textureId = getAminoGfx()->getAtlasTexture(page.page->atlas, true, newTexture).textureId;
+
+        base_assert(page.textureId != INVALID_TEXTURE);
+
+        if (newTexture) {
+            glyphsChanged = true;
+        }
+    }
 
     propLineNr->setValue(lineNr);
     propLineW->setValue(lineW);
@@ -1900,7 +2817,4 @@ bool AminoText::layoutText() {
     //printf("glyphs changed: %i\n", glyphsChanged);
 
     return glyphsChanged;
-}
-
-uv_mutex_t AminoText::freeTypeMutex;
-bool AminoText::freeTypeMutexInitialized = false;
\ No newline at end of file
+}
\ No newline at end of file
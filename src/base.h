@@ -6,6 +6,9 @@
 #include "base_weak.h"
 #include "fonts.h"
 #include "images.h"
+#include "trace.h"
+#include "hittest.h"
+#include "layout.h"
 
 #include <uv.h>
 #include "shaders.h"
@@ -32,6 +35,8 @@
 #define MODEL AMINO_MODEL
 #include <mutex>
 #include <thread>
+#include <atomic>
+#include <condition_variable>
 const int GROUP = 1;
 const int RECT  = 2;
 const int TEXT  = 3;
@@ -39,11 +44,22 @@ const int ANIM  = 4;
 const int POLY  = 5;
 const int MODEL = 6;
 
+class AminoNode;
 class AminoText;
 class AminoGroup;
 class AminoAnim;
 class AminoRenderer;
 
+/**
+ * Pending frame buffer readback.
+ */
+typedef struct {
+    Nan::Callback *callback;
+    char *data;
+    int32_t w;
+    int32_t h;
+} amino_readback_t;
+
 /**
  * Amino main class to call from JavaScript.
  *
@@ -65,13 +81,25 @@ public:
 
     //text
     void textUpdateNeeded(AminoText *text);
+    void cancelTextLayout(AminoText *text);
     amino_atlas_t getAtlasTexture(texture_atlas_t *atlas, bool createIfMissing, bool &newTexture);
+    void uploadAtlasTexture(texture_atlas_t *atlas);
     void notifyTextureCreated(int count);
     static void updateAtlasTextures(texture_atlas_t *atlas);
+    static void preloadAtlasTextures(amino_glyph_preload_t *preload);
 
     //video
     virtual AminoVideoPlayer *createVideoPlayer(AminoTexture *texture, AminoVideo *video) = 0;
 
+    //idle mode
+    void invalidateScene();
+
+    //hit testing
+    AminoHitIndex* getHitIndex();
+
+    //timer
+    double getRenderTime();
+
 protected:
     static int instanceCount;
     static std::vector<AminoGfx *> instances;
@@ -100,8 +128,12 @@ protected:
 
     //text
     std::vector<AminoText *> textUpdates;
+    AminoLayoutPool layoutPool;
+    uint32_t layoutThreads = 0; //0: layout on rendering thread
+    uint32_t textEvictions = 0; //atlas evictions at last check
 
     void updateTextNodes();
+    void queueEvictedTexts(AminoNode *node);
     virtual void atlasTextureHasChanged(texture_atlas_t *atlas);
     void updateAtlasTexture(texture_atlas_t *atlas);
     void updateAtlasTextureHandler(AsyncValueUpdate *update, int state);
@@ -121,6 +153,45 @@ protected:
     double lastCycleMin = 0;
     double lastCycleAvg = 0;
 
+    //performance (rendering phases)
+    static const int PHASE_ASYNC_QUEUE    = 0;
+    static const int PHASE_ANIMATIONS     = 1;
+    static const int PHASE_TEXT_UPDATES   = 2;
+    static const int PHASE_RENDER_SCENE   = 3;
+    static const int PHASE_RENDERING_DONE = 4;
+    static const int PHASE_COUNT          = 5;
+
+    static const int PHASE_SAMPLES = 256; //rolling window (frames)
+
+    double phaseFrame[PHASE_COUNT];
+    double phaseSamples[PHASE_SAMPLES][PHASE_COUNT];
+    double phaseTotals[PHASE_SAMPLES];
+    int phaseSamplePos = 0;
+    int phaseSampleCount = 0;
+    std::mutex phaseLock;
+
+    //idle mode (skip unchanged frames)
+    bool idleMode = false;
+    std::atomic<bool> sceneDirty { true };
+    bool frameSkipped = false;
+    std::mutex idleLock;
+    std::condition_variable idleCondition;
+    uint32_t renderedFrames = 0;
+    uint32_t skippedFrames = 0;
+    double idleTime = 0;
+
+    //fixed timestep (animation time advances per frame)
+    double fixedTimestep = 0;
+    double fixedTime = 0;
+
+    //readback
+    std::vector<amino_readback_t *> readbacks;
+
+    //hit testing (last rendered frame)
+    AminoHitIndex hitIndex;
+
+    void readPixels();
+
     //thread
     uv_thread_t thread;
     bool threadRunning = false;
@@ -176,6 +247,8 @@ protected:
     virtual void renderScene();
     virtual void renderingDone() = 0;
     bool isRendering();
+    void waitForSceneChange();
+    void asyncUpdatesAvailable() override;
 
     void destroy() override;
     void destroyAminoGfx();
@@ -207,6 +280,10 @@ private:
     static NAN_METHOD(UpdatePerspective);
     static NAN_METHOD(GetStats);
     static NAN_METHOD(GetTime);
+    static NAN_METHOD(ReadPixels);
+    static NAN_METHOD(StartTrace);
+    static NAN_METHOD(StopTrace);
+    static NAN_METHOD(HitTest);
 
     //animation
     void clearAnimations();
@@ -216,9 +293,19 @@ private:
     void deleteBuffer(AsyncValueUpdate *update, int state);
     void deleteVertexBuffer(AsyncValueUpdate *update, int state);
 
+    //readback
+    void readPixelsHandler(AsyncValueUpdate *update, int state);
+    void readPixelsDone(JSCallbackUpdate *update);
+
+    //glyph preloading
+    void preloadAtlasTexturesHandler(AsyncValueUpdate *update, int state);
+
     //stats
     void measureRenderingStart();
     void measureRenderingEnd();
+    double measurePhase(int phase, double startTime);
+    void addPhaseSample();
+    void getPhaseStats(v8::Local<v8::Object> &obj);
 };
 
 /**
@@ -258,12 +345,19 @@ public:
     //visibility
     BooleanProperty *propVisible;
 
+    //cached local transform (see AminoRenderer::applyTransform())
+    GLfloat localMatrix[16];
+    GLfloat localParams[10];
+    bool localMatrixValid = false;
+    bool localTranslateOnly = false;
+
     AminoNode(std::string name, int type): AminoJSObject(name), type(type) {
         //empty
     }
 
     ~AminoNode() {
         //see destroy
+        removeHitEntries();
     }
 
     void preInit(Nan::NAN_METHOD_ARGS_TYPE info) override {
@@ -307,6 +401,8 @@ public:
             return;
         }
 
+        removeHitEntries();
+
         AminoJSObject::destroy();
 
         //to be overwritten
@@ -346,6 +442,16 @@ public:
 
         return true;
     }
+
+private:
+    /**
+     * Remove node from the hit test index.
+     */
+    void removeHitEntries() {
+        if (eventHandler) {
+            static_cast<AminoGfx *>(eventHandler)->getHitIndex()->nodeDestroyed(this);
+        }
+    }
 };
 
 /**
@@ -382,6 +488,22 @@ public:
     ObjectProperty *propFont;
     AminoFontSize *fontSize = NULL;
     vertex_buffer_t *buffer = NULL;
+    GLfloat bounds[4] = { 0, 0, 0, 0 }; //glyph bounding box (x1, y1, x2, y2)
+
+    //atlas pages
+    std::vector<amino_text_page_t> pages;
+    std::vector<uint16_t> glyphPages; //page index of each glyph in buffer
+
+    //font of the current vertices (font property might be newer)
+    texture_font_t *layoutFont = NULL;
+    float layoutScale = 1;
+    bool layoutSdf = false;
+
+    //layouts (queued and swapped in)
+    uint32_t layoutGeneration = 0;
+    uint32_t appliedGeneration = 0;
+
+    static AminoLayoutCache layoutCache;
 
     //alignment
     Utf8Property *propAlign;
@@ -396,9 +518,20 @@ public:
     FloatProperty *propLineNr;
     FloatProperty *propLineW;
 
-    //mutex
-    static uv_mutex_t freeTypeMutex;
-    static bool freeTypeMutexInitialized;
+    //outline (SDF fonts)
+    FloatProperty *propOutlineW;
+    FloatProperty *propOutlineR;
+    FloatProperty *propOutlineG;
+    FloatProperty *propOutlineB;
+
+    //shadow (SDF fonts)
+    FloatProperty *propShadowX;
+    FloatProperty *propShadowY;
+    FloatProperty *propShadowBlur;
+    FloatProperty *propShadowR;
+    FloatProperty *propShadowG;
+    FloatProperty *propShadowB;
+    FloatProperty *propShadowOpacity;
 
     //constants
     static const int ALIGN_LEFT   = 0x0;
@@ -415,8 +548,7 @@ public:
     static const int WRAP_WORD = 0x2;
 
     AminoText(): AminoNode(getFactory()->name, TEXT) {
-        //mutex
-        initFreeTypeMutex();
+        //empty
     }
 
     ~AminoText() {
@@ -425,19 +557,6 @@ public:
         }
     }
 
-    /**
-     * Initialize the mutex.
-     */
-    static void initFreeTypeMutex() {
-        if (!freeTypeMutexInitialized) {
-            freeTypeMutexInitialized = true;
-
-            int res = uv_mutex_init(&freeTypeMutex);
-
-            assert(res == 0);
-        }
-    }
-
     /**
      * Free all resources.
      */
@@ -457,6 +576,11 @@ public:
      * Free buffers.
      */
     void destroyAminoText() {
+        //pending layouts
+        if (eventHandler) {
+            getAminoGfx()->cancelTextLayout(this);
+        }
+
         if (buffer) {
             if (eventHandler) {
                 if (getAminoGfx()->deleteVertexBufferAsync(buffer)) {
@@ -479,7 +603,9 @@ public:
         propFont->destroy();
 
         fontSize = NULL;
-        texture.textureId = INVALID_TEXTURE;
+        layoutFont = NULL;
+        pages.clear();
+        glyphPages.clear();
     }
 
     /**
@@ -509,6 +635,19 @@ public:
         propMaxLines = createInt32Property("maxLines");
         propLineNr = createFloatProperty("lineNr");
         propLineW = createFloatProperty("lineW");
+
+        propOutlineW = createFloatProperty("outlineW");
+        propOutlineR = createFloatProperty("outlineR");
+        propOutlineG = createFloatProperty("outlineG");
+        propOutlineB = createFloatProperty("outlineB");
+
+        propShadowX = createFloatProperty("shadowX");
+        propShadowY = createFloatProperty("shadowY");
+        propShadowBlur = createFloatProperty("shadowBlur");
+        propShadowR = createFloatProperty("shadowR");
+        propShadowG = createFloatProperty("shadowG");
+        propShadowB = createFloatProperty("shadowB");
+        propShadowOpacity = createFloatProperty("shadowOpacity");
     }
 
     //creation
@@ -627,7 +766,6 @@ public:
 
             //new font
             fontSize = fs;
-            texture.textureId = INVALID_TEXTURE; //reset texture
 
             //debug
             //printf("-> use font: %s\n", fs->font->fontName.c_str());
@@ -644,21 +782,23 @@ public:
      * Update the rendered text.
      */
     bool layoutText();
+    amino_text_layout_t *createLayout();
+    static void runLayout(amino_text_layout_t *layout);
+    bool applyLayout(amino_text_layout_t *layout);
 
     /**
-     * Create or update a font texture.
+     * Create or update the font textures.
      */
     void updateTexture();
-    static void updateTextureFromAtlas(GLuint textureId, texture_atlas_t *atlas);
+    static void updateTextureFromAtlas(GLuint textureId, texture_atlas_t *atlas, uint32_t &version);
 
     /**
-     * Get font texture.
+     * Atlas pages.
      */
-    GLuint getTextureId();
+    bool hasEvictedGlyphs();
+    void markPagesUsed();
 
 private:
-    amino_atlas_t texture = { INVALID_TEXTURE };
-
     /**
      * JS object construction.
      */
@@ -666,7 +806,8 @@ private:
         AminoJSObject::createInstance(info, getFactory());
     }
 
-    static void addTextGlyphs(vertex_buffer_t *buffer, texture_font_t *font, const char *text, vec2 *pen, int wrap, int width, int *lineNr, int maxLines, float *lineW);
+    static void addTextGlyphs(amino_text_layout_t *layout, vec2 *pen);
+    static uint16_t getPageIndex(amino_text_layout_t *layout, texture_atlas_t *atlas);
 };
 
 /**
@@ -1095,17 +1236,19 @@ public:
 
     /**
      * Next animation step.
+     *
+     * @return true if a value was applied.
      */
-    void update(double currentTime) {
+    bool update(double currentTime) {
         //check active
     	if (!started || ended) {
-            return;
+            return false;
         }
 
         //check remaining loops
         if (count == 0) {
             endAnimation();
-            return;
+            return true;
         }
 
         //handle first start
@@ -1122,7 +1265,7 @@ public:
                     //in future: wait
                     startTime = 0;
                     lastTime = 0;
-                    return;
+                    return false;
                 }
 
                 //check passed iterations
@@ -1134,7 +1277,7 @@ public:
                         if (cycles >= count) {
                             //end reached
                             endAnimation();
-                            return;
+                            return true;
                         }
 
                         //reduce
@@ -1190,7 +1333,7 @@ public:
                     doToggle = true;
                 } else {
                     endAnimation();
-                    return;
+                    return true;
                 }
             }
 
@@ -1230,6 +1373,8 @@ public:
         double value = timeToPosition(t);
 
         applyValue(value);
+
+        return true;
     }
 };
 
@@ -1489,6 +1634,7 @@ public:
         propFilled = createBooleanProperty("filled");
 
         propGeometry = createFloatArrayProperty("geometry");
+        propGeometry->shared = true;
     }
 
     //creation
@@ -1636,6 +1782,11 @@ public:
         propUVs = createFloatArrayProperty("uvs");
         propIndices = createUShortArrayProperty("indices");
 
+        //zero-copy geometry
+        propVertices->shared = true;
+        propNormals->shared = true;
+        propUVs->shared = true;
+
         propTexture = createObjectProperty("texture");
     }
 
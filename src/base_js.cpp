@@ -1,12 +1,19 @@
 #include "base_js.h"
+#include "trace.h"
 
 #include <sstream>
+#include <chrono>
+#include <algorithm>
 #define DEBUG_ASYNC false
 #define DEBUG_JS_INSTANCES false
 #define DEBUG_PROPERTIES false
 
 #define base_js_assert(x) _base_js_assert((void*)((x)), __LINE__)
 
+//update pool limits (per size class)
+#define UPDATE_POOL_MAX_BLOCKS 4096
+#define UPDATE_POOL_MAX_VECTOR 4096
+
 void _base_js_assert(void* x, int line) {
     if (x) return;
     printf("ERROR base js assertion failed on line %d\n", line);
@@ -32,6 +39,199 @@ AminoJSObject* AminoJSObjectFactory::create() {
     return NULL;
 }
 
+//
+//  AminoUpdatePool
+//
+
+/**
+ * Block header (keeps the data aligned).
+ */
+struct alignas(16) amino_pool_block_t {
+    AminoUpdatePool *pool;
+    std::size_t sizeClass;
+};
+
+typedef std::vector<float> amino_float_vector_t;
+
+AminoUpdatePool::AminoUpdatePool() {
+    //empty
+}
+
+/**
+ * Destructor.
+ *
+ * Note: all blocks have to be freed before.
+ */
+AminoUpdatePool::~AminoUpdatePool() {
+    for (auto &list : blocks) {
+        for (auto const &block : list) {
+            ::operator delete(block);
+        }
+    }
+
+    for (auto const &vector : floatVectors) {
+        vector->~amino_float_vector_t();
+        ::operator delete((amino_pool_block_t *)vector - 1);
+    }
+}
+
+/**
+ * Allocate a block (pool is optional).
+ *
+ * Note: thread-safe.
+ */
+void* AminoUpdatePool::allocBlock(AminoUpdatePool *pool, std::size_t size) {
+    std::size_t sizeClass = (size + sizeof(amino_pool_block_t) - 1) / BLOCK_SIZE;
+    amino_pool_block_t *block = NULL;
+
+    if (pool && sizeClass < CLASS_COUNT) {
+        std::lock_guard<std::mutex> guard(pool->lock);
+        std::vector<void *> &list = pool->blocks[sizeClass];
+
+        if (!list.empty()) {
+            block = (amino_pool_block_t *)list.back();
+            list.pop_back();
+            pool->poolAllocs++;
+        } else {
+            pool->heapAllocs++;
+        }
+    }
+
+    if (!block) {
+        block = (amino_pool_block_t *)::operator new((sizeClass + 1) * BLOCK_SIZE);
+        block->pool = pool;
+        block->sizeClass = sizeClass;
+    }
+
+    return block + 1;
+}
+
+/**
+ * Free a block.
+ *
+ * Note: thread-safe.
+ */
+void AminoUpdatePool::freeBlock(void *ptr) {
+    if (!ptr) {
+        return;
+    }
+
+    amino_pool_block_t *block = (amino_pool_block_t *)ptr - 1;
+
+    if (block->pool && block->sizeClass < CLASS_COUNT) {
+        block->pool->recycle(block, block->sizeClass);
+    } else {
+        ::operator delete(block);
+    }
+}
+
+/**
+ * Keep a block for reuse.
+ */
+void AminoUpdatePool::recycle(void *block, std::size_t sizeClass) {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        std::vector<void *> &list = blocks[sizeClass];
+
+        if (list.size() < UPDATE_POOL_MAX_BLOCKS) {
+            list.push_back(block);
+
+            return;
+        }
+    }
+
+    ::operator delete(block);
+}
+
+/**
+ * Get an empty float vector (keeps the capacity of recycled vectors).
+ *
+ * Note: thread-safe.
+ */
+std::vector<float>* AminoUpdatePool::allocFloatVector(AminoUpdatePool *pool) {
+    if (pool) {
+        std::lock_guard<std::mutex> guard(pool->lock);
+
+        if (!pool->floatVectors.empty()) {
+            std::vector<float> *vector = pool->floatVectors.back();
+
+            pool->floatVectors.pop_back();
+            pool->poolAllocs++;
+
+            return vector;
+        }
+    }
+
+    return new (allocBlock(pool, sizeof(amino_float_vector_t))) amino_float_vector_t();
+}
+
+/**
+ * Free a float vector.
+ *
+ * Note: thread-safe.
+ */
+void AminoUpdatePool::freeFloatVector(std::vector<float> *vector) {
+    if (!vector) {
+        return;
+    }
+
+    amino_pool_block_t *block = (amino_pool_block_t *)vector - 1;
+
+    if (block->pool && block->pool->recycleFloatVector(vector)) {
+        return;
+    }
+
+    vector->~amino_float_vector_t();
+    freeBlock(vector);
+}
+
+/**
+ * Keep a float vector for reuse.
+ *
+ * Returns false if the vector has to be freed.
+ */
+bool AminoUpdatePool::recycleFloatVector(std::vector<float> *vector) {
+    if (vector->capacity() > UPDATE_POOL_MAX_VECTOR) {
+        return false;
+    }
+
+    vector->clear();
+
+    std::lock_guard<std::mutex> guard(lock);
+
+    if (floatVectors.size() >= UPDATE_POOL_MAX_BLOCKS) {
+        return false;
+    }
+
+    floatVectors.push_back(vector);
+
+    return true;
+}
+
+/**
+ * Get the allocation statistics.
+ */
+void AminoUpdatePool::getStats(v8::Local<v8::Object> &obj) {
+    lock.lock();
+
+    uint32_t heapAllocs = this->heapAllocs;
+    uint32_t poolAllocs = this->poolAllocs;
+    uint32_t freeCount = floatVectors.size();
+
+    for (auto const &list : blocks) {
+        freeCount += list.size();
+    }
+
+    lock.unlock();
+
+    v8::Local<v8::Object> poolObj = Nan::New<v8::Object>();
+
+    Nan::Set(poolObj, Nan::New("heapAllocs").ToLocalChecked(), Nan::New(heapAllocs));
+    Nan::Set(poolObj, Nan::New("poolAllocs").ToLocalChecked(), Nan::New(poolAllocs));
+    Nan::Set(poolObj, Nan::New("free").ToLocalChecked(), Nan::New(freeCount));
+    Nan::Set(obj, Nan::New("updatePool").ToLocalChecked(), poolObj);
+}
+
 //
 //  AminoJSObject
 //
@@ -483,9 +683,9 @@ void AminoJSObject::addProperty(AnyProperty *prop) {
  * Callback from property watcher to update native value.
  */
 NAN_METHOD(AminoJSObject::PropertyUpdated) {
-    base_js_assert(info.Length() == 3);
+    base_js_assert(info.Length() == 3 || info.Length() == 5);
 
-    //params: value, propId, object
+    //params: value, propId, object, (start, count)
     uint32_t id = Nan::To<v8::Uint32>(info[1]).ToLocalChecked()->Value();
 
     //pass to object instance
@@ -495,9 +695,111 @@ NAN_METHOD(AminoJSObject::PropertyUpdated) {
 
     base_js_assert(obj);
 
+    //changed range (typed array modified in place)
+    if (info.Length() == 5) {
+        AnyProperty *prop = obj->getPropertyWithId(id);
+
+        if (prop && prop->type == PROPERTY_FLOAT_ARRAY) {
+            uint32_t start = Nan::To<v8::Uint32>(info[3]).ToLocalChecked()->Value();
+            uint32_t count = Nan::To<v8::Uint32>(info[4]).ToLocalChecked()->Value();
+
+            static_cast<FloatArrayProperty *>(prop)->setNextRange(start, count);
+        }
+    }
+
     obj->enqueuePropertyUpdate(id, value);
 }
 
+/**
+ * Apply batched property updates (single call for many properties).
+ *
+ * Params: records (Float64Array; object index, property id, value type, value), record count, objects, values (other types).
+ */
+NAN_METHOD(AminoJSObject::PropertiesUpdated) {
+    base_js_assert(info.Length() == 4);
+    base_js_assert(info[0]->IsFloat64Array());
+
+    v8::Local<v8::Float64Array> records = v8::Local<v8::Float64Array>::Cast(info[0]);
+    uint32_t count = Nan::To<v8::Uint32>(info[1]).ToLocalChecked()->Value();
+    v8::Local<v8::Array> objects = v8::Local<v8::Array>::Cast(info[2]);
+    v8::Local<v8::Array> values = v8::Local<v8::Array>::Cast(info[3]);
+
+    base_js_assert(count * BATCH_RECORD_SIZE <= records->Length());
+
+    double *data = (double *)((char *)records->Buffer()->GetContents().Data() + records->ByteOffset());
+
+    //objects
+    uint32_t objectCount = objects->Length();
+    std::vector<AminoJSObject *> objs(objectCount);
+
+    for (uint32_t i = 0; i < objectCount; i++) {
+        v8::Local<v8::Object> jsObj = Nan::To<v8::Object>(Nan::Get(objects, i).ToLocalChecked()).ToLocalChecked();
+
+        objs[i] = Nan::ObjectWrap::Unwrap<AminoJSObject>(jsObj);
+    }
+
+    //collect updates (in order; enqueued per event handler)
+    AminoJSEventObject *eventHandler = NULL;
+    std::vector<AnyAsyncUpdate *> updates;
+
+    for (uint32_t i = 0; i < count; i++) {
+        double *record = data + i * BATCH_RECORD_SIZE;
+        uint32_t index = (uint32_t)record[0];
+
+        base_js_assert(index < objectCount);
+
+        AminoJSObject *obj = objs[index];
+
+        base_js_assert(obj);
+
+        if (obj->destroyed) {
+            continue;
+        }
+
+        AnyProperty *prop = obj->getPropertyWithId((uint32_t)record[1]);
+        AminoJSEventObject *handler = obj->getEventHandler();
+
+        base_js_assert(prop);
+        base_js_assert(handler);
+
+        if (handler != eventHandler) {
+            if (eventHandler) {
+                eventHandler->enqueuePropertyUpdates(updates);
+            }
+
+            eventHandler = handler;
+        }
+
+        //value
+        v8::Local<v8::Value> value;
+
+        switch ((uint32_t)record[2]) {
+            case BATCH_VALUE_NUMBER:
+                value = Nan::New<v8::Number>(record[3]);
+                break;
+
+            case BATCH_VALUE_BOOL:
+                value = Nan::New<v8::Boolean>(record[3] != 0);
+                break;
+
+            default:
+                value = Nan::Get(values, (uint32_t)record[3]).ToLocalChecked();
+                break;
+        }
+
+        bool valid;
+        AsyncPropertyUpdate *update = handler->createPropertyUpdate(prop, value, valid);
+
+        if (update) {
+            updates.push_back(update);
+        }
+    }
+
+    if (eventHandler) {
+        eventHandler->enqueuePropertyUpdates(updates);
+    }
+}
+
 /**
  * Set the event handler instance.
  *
@@ -540,7 +842,7 @@ bool AminoJSObject::isEventHandler() {
  * Note: has to be called on main thread.
  */
 bool AminoJSObject::enqueueValueUpdate(AminoJSObject *value, asyncValueCallback callback) {
-    return enqueueValueUpdate(new AsyncValueUpdate(this, value, callback));
+    return enqueueValueUpdate(new (getUpdatePool()) AsyncValueUpdate(this, value, callback));
 }
 
 /**
@@ -549,7 +851,7 @@ bool AminoJSObject::enqueueValueUpdate(AminoJSObject *value, asyncValueCallback
  * Note: has to be called on main thread.
  */
 bool AminoJSObject::enqueueValueUpdate(unsigned int value, void *data, asyncValueCallback callback) {
-    return enqueueValueUpdate(new AsyncValueUpdate(this, value, data, callback));
+    return enqueueValueUpdate(new (getUpdatePool()) AsyncValueUpdate(this, value, data, callback));
 }
 
 /**
@@ -558,7 +860,7 @@ bool AminoJSObject::enqueueValueUpdate(unsigned int value, void *data, asyncValu
  * Note: has to be called on main thread.
  */
 bool AminoJSObject::enqueueValueUpdate(v8::Local<v8::Value> &value, void *data, asyncValueCallback callback) {
-    return enqueueValueUpdate(new AsyncValueUpdate(this, value, data, callback));
+    return enqueueValueUpdate(new (getUpdatePool()) AsyncValueUpdate(this, value, data, callback));
 }
 
 /**
@@ -648,6 +950,15 @@ AminoJSEventObject* AminoJSObject::getEventHandler() {
     return eventHandler;
 }
 
+/**
+ * Get the allocator of async updates (NULL if there is no event handler).
+ */
+AminoUpdatePool* AminoJSObject::getUpdatePool() {
+    AminoJSEventObject *eventHandler = getEventHandler();
+
+    return eventHandler ? &eventHandler->updatePool:NULL;
+}
+
 /**
  * Enqueue a property update.
  *
@@ -702,7 +1013,7 @@ bool AminoJSObject::enqueueJSCallbackUpdate(jsUpdateCallback callbackApply, jsUp
     AminoJSEventObject *eventHandler = getEventHandler();
 
     if (eventHandler) {
-        return eventHandler->enqueueJSUpdate(new JSCallbackUpdate(this, callbackApply, callbackDone, data));
+        return eventHandler->enqueueJSUpdate(new (&eventHandler->updatePool) JSCallbackUpdate(this, callbackApply, callbackDone, data));
     }
 
     if (DEBUG_BASE) {
@@ -880,6 +1191,20 @@ void AminoJSObject::AnyProperty::release() {
     obj->release();
 }
 
+/**
+ * Get the allocator of async data.
+ */
+AminoUpdatePool* AminoJSObject::AnyProperty::getUpdatePool() {
+    return obj->getUpdatePool();
+}
+
+/**
+ * Merge an update which was replaced by a newer one (default: nothing to merge).
+ */
+void AminoJSObject::AnyProperty::mergeAsyncData(void *data, void *oldData) {
+    //empty
+}
+
 //
 // AminoJSObject::FloatProperty
 //
@@ -937,7 +1262,7 @@ void* AminoJSObject::FloatProperty::getAsyncData(v8::Local<v8::Value> &value, bo
     if (value->IsNumber()) {
         //double to float
         float f = Nan::To<v8::Number>(value).ToLocalChecked()->Value();
-        float *res = new float;
+        float *res = (float *)AminoUpdatePool::allocBlock(getUpdatePool(), sizeof(float));
 
         *res = f;
         valid = true;
@@ -967,9 +1292,7 @@ void AminoJSObject::FloatProperty::setAsyncData(AsyncPropertyUpdate *update, voi
  * Free async data.
  */
 void AminoJSObject::FloatProperty::freeAsyncData(void *data) {
-    if (data) {
-        delete (float *)data;
-    }
+    AminoUpdatePool::freeBlock(data);
 }
 
 //
@@ -985,15 +1308,18 @@ AminoJSObject::FloatArrayProperty::FloatArrayProperty(AminoJSObject *obj, std::s
 
 /**
  * FloatProperty destructor.
+ *
+ * Note: called on main thread.
  */
 AminoJSObject::FloatArrayProperty::~FloatArrayProperty() {
-    //empty
+    freeView(view);
+    view = NULL;
 }
 
 /**
  * Update the float value.
  *
- * Note: only updates the JS value if modified!
+ * Note: only updates the JS value if modified! Not supported in zero-copy mode.
  */
 void AminoJSObject::FloatArrayProperty::setValue(std::vector<float> newValue) {
     if (value != newValue) {
@@ -1005,12 +1331,63 @@ void AminoJSObject::FloatArrayProperty::setValue(std::vector<float> newValue) {
     }
 }
 
+/**
+ * Get the current values.
+ */
+float* AminoJSObject::FloatArrayProperty::getData() {
+    return view ? view->data:value.data();
+}
+
+/**
+ * Get the number of values.
+ */
+std::size_t AminoJSObject::FloatArrayProperty::getSize() {
+    return view ? view->size:value.size();
+}
+
+/**
+ * Limit the next update to a range (typed array modified in place).
+ *
+ * Note: called on main thread.
+ */
+void AminoJSObject::FloatArrayProperty::setNextRange(std::size_t start, std::size_t count) {
+    hasNextRange = true;
+    nextStart = start;
+    nextEnd = start + count;
+}
+
+/**
+ * Get the range changed since the last upload.
+ *
+ * Returns false if all values have to be uploaded.
+ */
+bool AminoJSObject::FloatArrayProperty::getChangedRange(std::size_t &start, std::size_t &end) {
+    if (changedAll) {
+        return false;
+    }
+
+    start = changedStart;
+    end = changedEnd;
+
+    return true;
+}
+
+/**
+ * Values were uploaded.
+ */
+void AminoJSObject::FloatArrayProperty::clearChangedRange() {
+    changedAll = false;
+    changedStart = 0;
+    changedEnd = 0;
+}
+
 /**
  * Convert to string value.
  */
 std::string AminoJSObject::FloatArrayProperty::toString() {
     std::ostringstream ss;
-    std::size_t count = value.size();
+    float *data = getData();
+    std::size_t count = getSize();
 
     ss << "[";
 
@@ -1019,7 +1396,7 @@ std::string AminoJSObject::FloatArrayProperty::toString() {
             ss << ", ";
         }
 
-        ss << value[i];
+        ss << data[i];
     }
 
     ss << "]";
@@ -1031,7 +1408,8 @@ std::string AminoJSObject::FloatArrayProperty::toString() {
  * Get JS value.
  */
 v8::Local<v8::Value> AminoJSObject::FloatArrayProperty::toValue() {
-    std::size_t count = value.size();
+    float *data = getData();
+    std::size_t count = getSize();
 
     //typed array
     v8::Local<v8::Float32Array> arr = v8::Float32Array::New(v8::ArrayBuffer::New(v8::Isolate::GetCurrent(), count * sizeof(float)), 0, count);
@@ -1040,7 +1418,7 @@ v8::Local<v8::Value> AminoJSObject::FloatArrayProperty::toValue() {
     //v8::Local<v8::Array> arr = Nan::New<v8::Array>();
 
     for (unsigned int i = 0; i < count; i++) {
-        Nan::Set(arr, Nan::New<v8::Uint32>(i), Nan::New<v8::Number>(value[i]));
+        Nan::Set(arr, Nan::New<v8::Uint32>(i), Nan::New<v8::Number>(data[i]));
     }
 
     return arr;
@@ -1048,29 +1426,59 @@ v8::Local<v8::Value> AminoJSObject::FloatArrayProperty::toValue() {
 
 /**
  * Get async data representation.
+ *
+ * In zero-copy mode a view of the Float32Array is returned.
  */
 void* AminoJSObject::FloatArrayProperty::getAsyncData(v8::Local<v8::Value> &value, bool &valid) {
     if (value->IsNull()) {
         //Note: only accepting empty arrays as values
         valid = false;
+        hasNextRange = false;
 
         return NULL;
     }
 
+    if (shared) {
+        v8::Local<v8::Float32Array> arr;
+
+        if (value->IsFloat32Array()) {
+            arr = v8::Local<v8::Float32Array>::Cast(value);
+        } else if (value->IsArray()) {
+            //copy to new Float32Array
+            v8::Local<v8::Array> values = v8::Local<v8::Array>::Cast(value);
+            std::size_t count = values->Length();
+
+            arr = v8::Float32Array::New(v8::ArrayBuffer::New(v8::Isolate::GetCurrent(), count * sizeof(float)), 0, count);
+
+            for (std::size_t i = 0; i < count; i++) {
+                Nan::Set(arr, (uint32_t)i, Nan::Get(values, i).ToLocalChecked());
+            }
+        } else {
+            valid = false;
+            hasNextRange = false;
+
+            return NULL;
+        }
+
+        valid = true;
+
+        return createView(arr);
+    }
+
     std::vector<float> *vector =  NULL;
 
     if (value->IsFloat32Array()) {
         //Float32Array
         v8::Local<v8::Float32Array> arr = v8::Local<v8::Float32Array>::Cast(value);
         v8::ArrayBuffer::Contents contents = arr->Buffer()->GetContents();
-        float *data = (float *)contents.Data();
-        std::size_t count = contents.ByteLength() / sizeof(float);
+        float *data = (float *)((char *)contents.Data() + arr->ByteOffset());
+        std::size_t count = arr->Length();
 
         //debug
         //printf("is Float32Array (size: %i)\n", (int)count);
 
         //copy to vector
-        vector = new std::vector<float>();
+        vector = AminoUpdatePool::allocFloatVector(getUpdatePool());
 
         vector->assign(data, data + count);
 
@@ -1079,7 +1487,8 @@ void* AminoJSObject::FloatArrayProperty::getAsyncData(v8::Local<v8::Value> &valu
         v8::Local<v8::Array> arr = v8::Local<v8::Array>::Cast(value);
         std::size_t count = arr->Length();
 
-        vector = new std::vector<float>();
+        vector = AminoUpdatePool::allocFloatVector(getUpdatePool());
+        vector->reserve(count);
 
         for (std::size_t i = 0; i < count; i++) {
             vector->push_back((float)(Nan::To<v8::Number>(Nan::Get(arr, i).ToLocalChecked()).ToLocalChecked()->Value()));
@@ -1093,24 +1502,137 @@ void* AminoJSObject::FloatArrayProperty::getAsyncData(v8::Local<v8::Value> &valu
     return vector;
 }
 
+/**
+ * Create a view of a Float32Array (uses the next range).
+ */
+amino_float_view_t* AminoJSObject::FloatArrayProperty::createView(v8::Local<v8::Float32Array> arr) {
+    amino_float_view_t *res = new (AminoUpdatePool::allocBlock(getUpdatePool(), sizeof(amino_float_view_t))) amino_float_view_t();
+
+#if V8_MAJOR_VERSION >= 8
+    //keep memory (buffer could be detached)
+    res->store = arr->Buffer()->GetBackingStore();
+
+    if (res->store && res->store->Data()) {
+        res->data = (float *)((char *)res->store->Data() + arr->ByteOffset());
+        res->size = arr->Length();
+    }
+
+    res->source = res->data;
+#else
+    //copy values
+    v8::ArrayBuffer::Contents contents = arr->Buffer()->GetContents();
+    float *data = (float *)((char *)contents.Data() + arr->ByteOffset());
+
+    res->source = data;
+    res->copy.assign(data, data + arr->Length());
+    res->data = res->copy.data();
+    res->size = res->copy.size();
+#endif
+
+    //range
+    if (hasNextRange) {
+        hasNextRange = false;
+
+        res->changedAll = false;
+        res->changedStart = std::min(nextStart, res->size);
+        res->changedEnd = std::min(nextEnd, res->size);
+    }
+
+    return res;
+}
+
+/**
+ * Free a view.
+ */
+void AminoJSObject::FloatArrayProperty::freeView(amino_float_view_t *view) {
+    if (!view) {
+        return;
+    }
+
+    view->~amino_float_view_t();
+    AminoUpdatePool::freeBlock(view);
+}
+
 /**
  * Apply async data.
  */
 void AminoJSObject::FloatArrayProperty::setAsyncData(AsyncPropertyUpdate *update, void *data) {
     if (!data) {
         value.clear();
+        changedAll = true;
+        return;
+    }
+
+    if (shared) {
+        amino_float_view_t *newView = (amino_float_view_t *)data;
+
+        if (!update) {
+            //Note: view is released by caller
+            value.assign(newView->data, newView->data + newView->size);
+            changedAll = true;
+            return;
+        }
+
+        //changed range
+        if (!view || view->source != newView->source || view->size != newView->size || newView->changedAll) {
+            changedAll = true;
+        } else if (!changedAll) {
+            if (changedStart == changedEnd) {
+                changedStart = newView->changedStart;
+                changedEnd = newView->changedEnd;
+            } else if (newView->changedStart != newView->changedEnd) {
+                changedStart = std::min(changedStart, newView->changedStart);
+                changedEnd = std::max(changedEnd, newView->changedEnd);
+            }
+        }
+
+        //swap (previous view is released with the update on main thread)
+        update->data = view;
+        view = newView;
+
         return;
     }
 
     value = *((std::vector<float> *)data);
+    changedAll = true;
 }
 
 /**
  * Free async data.
  */
 void AminoJSObject::FloatArrayProperty::freeAsyncData(void *data) {
-    if (data) {
-        delete (std::vector<float> *)data;
+    if (shared) {
+        freeView((amino_float_view_t *)data);
+    } else {
+        AminoUpdatePool::freeFloatVector((std::vector<float> *)data);
+    }
+}
+
+/**
+ * Merge the changed range of a coalesced update.
+ */
+void AminoJSObject::FloatArrayProperty::mergeAsyncData(void *data, void *oldData) {
+    if (!shared || !data || !oldData) {
+        return;
+    }
+
+    amino_float_view_t *newView = (amino_float_view_t *)data;
+    amino_float_view_t *oldView = (amino_float_view_t *)oldData;
+
+    if (newView->changedAll) {
+        return;
+    }
+
+    if (oldView->changedAll || oldView->source != newView->source || oldView->size != newView->size) {
+        newView->changedAll = true;
+    } else if (oldView->changedStart != oldView->changedEnd) {
+        if (newView->changedStart == newView->changedEnd) {
+            newView->changedStart = oldView->changedStart;
+            newView->changedEnd = oldView->changedEnd;
+        } else {
+            newView->changedStart = std::min(newView->changedStart, oldView->changedStart);
+            newView->changedEnd = std::max(newView->changedEnd, oldView->changedEnd);
+        }
     }
 }
 
@@ -1167,7 +1689,7 @@ v8::Local<v8::Value> AminoJSObject::DoubleProperty::toValue() {
 void* AminoJSObject::DoubleProperty::getAsyncData(v8::Local<v8::Value> &value, bool &valid) {
     if (value->IsNumber()) {
         double d = Nan::To<v8::Number>(value).ToLocalChecked()->Value();
-        double *res = new double;
+        double *res = (double *)AminoUpdatePool::allocBlock(getUpdatePool(), sizeof(double));
 
         *res = d;
         valid = true;
@@ -1197,9 +1719,7 @@ void AminoJSObject::DoubleProperty::setAsyncData(AsyncPropertyUpdate *update, vo
  * Free async data.
  */
 void AminoJSObject::DoubleProperty::freeAsyncData(void *data) {
-    if (data) {
-        delete (double *)data;
-    }
+    AminoUpdatePool::freeBlock(data);
 }
 
 //
@@ -1398,7 +1918,7 @@ void* AminoJSObject::Int32Property::getAsyncData(v8::Local<v8::Value> &value, bo
     if (value->IsNumber()) {
         //UInt32
         int32_t i = Nan::To<v8::Int32>(value).ToLocalChecked()->Value();
-        int32_t *res = new int32_t;
+        int32_t *res = (int32_t *)AminoUpdatePool::allocBlock(getUpdatePool(), sizeof(int32_t));
 
         *res = i;
         valid = true;
@@ -1428,9 +1948,7 @@ void AminoJSObject::Int32Property::setAsyncData(AsyncPropertyUpdate *update, voi
  * Free async data.
  */
 void AminoJSObject::Int32Property::freeAsyncData(void *data) {
-    if (data) {
-        delete (int32_t *)data;
-    }
+    AminoUpdatePool::freeBlock(data);
 }
 
 //
@@ -1487,7 +2005,7 @@ void* AminoJSObject::UInt32Property::getAsyncData(v8::Local<v8::Value> &value, b
     if (value->IsNumber()) {
         //UInt32
         uint32_t ui = Nan::To<v8::Uint32>(value).ToLocalChecked()->Value();
-        uint32_t *res = new uint32_t;
+        uint32_t *res = (uint32_t *)AminoUpdatePool::allocBlock(getUpdatePool(), sizeof(uint32_t));
 
         *res = ui;
         valid = true;
@@ -1517,9 +2035,7 @@ void AminoJSObject::UInt32Property::setAsyncData(AsyncPropertyUpdate *update, vo
  * Free async data.
  */
 void AminoJSObject::UInt32Property::freeAsyncData(void *data) {
-    if (data) {
-        delete (uint32_t *)data;
-    }
+    AminoUpdatePool::freeBlock(data);
 }
 
 //
@@ -1575,7 +2091,7 @@ v8::Local<v8::Value> AminoJSObject::BooleanProperty::toValue() {
 void* AminoJSObject::BooleanProperty::getAsyncData(v8::Local<v8::Value> &value, bool &valid) {
     if (value->IsBoolean()) {
         bool b = Nan::To<v8::Boolean>(value).ToLocalChecked()->Value();
-        bool *res = new bool;
+        bool *res = (bool *)AminoUpdatePool::allocBlock(getUpdatePool(), sizeof(bool));
 
         *res = b;
         valid = true;
@@ -1605,9 +2121,7 @@ void AminoJSObject::BooleanProperty::setAsyncData(AsyncPropertyUpdate *update, v
  * Free async data.
  */
 void AminoJSObject::BooleanProperty::freeAsyncData(void *data) {
-    if (data) {
-        delete (bool *)data;
-    }
+    AminoUpdatePool::freeBlock(data);
 }
 
 //
@@ -1840,6 +2354,33 @@ AminoJSObject::AnyAsyncUpdate::~AnyAsyncUpdate() {
     //empty
 }
 
+/**
+ * Allocate on heap.
+ */
+void* AminoJSObject::AnyAsyncUpdate::operator new(std::size_t size) {
+    return AminoUpdatePool::allocBlock(NULL, size);
+}
+
+/**
+ * Allocate from pool.
+ */
+void* AminoJSObject::AnyAsyncUpdate::operator new(std::size_t size, AminoUpdatePool *pool) {
+    return AminoUpdatePool::allocBlock(pool, size);
+}
+
+/**
+ * Free (recycled by pool).
+ *
+ * Note: thread-safe.
+ */
+void AminoJSObject::AnyAsyncUpdate::operator delete(void *ptr) {
+    AminoUpdatePool::freeBlock(ptr);
+}
+
+void AminoJSObject::AnyAsyncUpdate::operator delete(void *ptr, AminoUpdatePool *pool) {
+    AminoUpdatePool::freeBlock(ptr);
+}
+
 //
 // AminoJSObject::AsyncValueUpdate
 //
@@ -1979,6 +2520,7 @@ void AminoJSObject::JSCallbackUpdate::apply() {
 
 AminoJSEventObject::AminoJSEventObject(std::string name): AminoJSObject(name) {
     asyncUpdates = new std::vector<AnyAsyncUpdate *>();
+    asyncProcessing = new std::vector<AnyAsyncUpdate *>();
     asyncDeletes = new std::vector<AnyAsyncUpdate *>();
     jsUpdates = new std::vector<AnyAsyncUpdate *>();
 
@@ -2012,6 +2554,7 @@ AminoJSEventObject::~AminoJSEventObject() {
     //asyncUpdates
     clearAsyncQueue();
     delete asyncUpdates;
+    delete asyncProcessing;
 
     //asyncDeletes
     handleAsyncDeletes();
@@ -2038,9 +2581,7 @@ AminoJSEventObject* AminoJSEventObject::getEventHandler() {
 void AminoJSEventObject::clearAsyncQueue() {
     base_js_assert(asyncUpdates);
 
-    asyncLock.lock();
-
-    // base_js_assert(res == 0);
+    asyncQueueLock.lock();
 
     std::size_t count = asyncUpdates->size();
 
@@ -2052,9 +2593,9 @@ void AminoJSEventObject::clearAsyncQueue() {
 
     //Note: not applied, can safely clear vector
     asyncUpdates->clear();
+    resetAsyncPending();
 
-    asyncLock.unlock();
-    // base_js_assert(res == 0);
+    asyncQueueLock.unlock();
 }
 
 /**
@@ -2114,6 +2655,8 @@ void AminoJSEventObject::handleJSUpdates() {
     std::size_t count = jsUpdates->size();
 
     if (count > 0) {
+        TRACE_SCOPE("handleJSUpdates");
+
         //create scope
         Nan::HandleScope scope;
 
@@ -2149,6 +2692,31 @@ void AminoJSEventObject::getStats(v8::Local<v8::Object> &obj) {
     Nan::Set(obj, Nan::New("asyncDeletes").ToLocalChecked(), Nan::New<v8::Uint32>((uint32_t)asyncDeletes->size()));
     */
 
+    //async queue
+    asyncQueueLock.lock();
+
+    uint32_t depth = asyncUpdates->size();
+    uint32_t maxDepth = asyncMaxDepth;
+    uint32_t enqueued = asyncEnqueued;
+    uint32_t coalesced = asyncCoalesced;
+    double waitTime = asyncWaitTime;
+    double maxWait = asyncMaxWait;
+
+    asyncQueueLock.unlock();
+
+    v8::Local<v8::Object> queueObj = Nan::New<v8::Object>();
+
+    Nan::Set(queueObj, Nan::New("depth").ToLocalChecked(), Nan::New(depth));
+    Nan::Set(queueObj, Nan::New("maxDepth").ToLocalChecked(), Nan::New(maxDepth));
+    Nan::Set(queueObj, Nan::New("enqueued").ToLocalChecked(), Nan::New(enqueued));
+    Nan::Set(queueObj, Nan::New("coalesced").ToLocalChecked(), Nan::New(coalesced));
+    Nan::Set(queueObj, Nan::New("waitTime").ToLocalChecked(), Nan::New(waitTime));
+    Nan::Set(queueObj, Nan::New("maxWait").ToLocalChecked(), Nan::New(maxWait));
+    Nan::Set(obj, Nan::New("asyncQueue").ToLocalChecked(), queueObj);
+
+    //allocations
+    updatePool.getStats(obj);
+
     //output instance stats
     if (DEBUG_JS_INSTANCES) {
         //collect items
@@ -2195,11 +2763,13 @@ bool AminoJSEventObject::isEventHandler() {
 /**
  * Process all queued updates.
  *
+ * Returns true if at least one update was processed.
+ *
  * Note: runs on rendering thread.
  */
-void AminoJSEventObject::processAsyncQueue() {
+bool AminoJSEventObject::processAsyncQueue() {
     if (destroyed) {
-        return;
+        return false;
     }
 
     if (DEBUG_BASE) {
@@ -2208,78 +2778,117 @@ void AminoJSEventObject::processAsyncQueue() {
         printf("--- processAsyncQueue() --- \n");
     }
 
-    //iterate
     base_js_assert(asyncUpdates);
+    base_js_assert(asyncProcessing);
 
-    asyncLock.lock();
+    bool processed = false;
 
-    // base_js_assert(res == 0);
+    //Note: updates added while processing are handled in the next pass
+    while (true) {
+        //swap buffers (producers are not blocked while the items are handled)
+        asyncQueueLock.lock();
 
-    for (std::size_t i = 0; i < asyncUpdates->size(); i++) {
-        AnyAsyncUpdate *item = (*asyncUpdates)[i];
+        std::swap(asyncUpdates, asyncProcessing);
+        resetAsyncPending();
 
-        base_js_assert(item);
+        std::size_t count = asyncProcessing->size();
 
-        //debug
-        //printf("%i of %i (type: %i)\n", (int)i, (int)asyncUpdates->size(), (int)item->type);
+        if (count > asyncMaxDepth) {
+            asyncMaxDepth = count;
+        }
 
-        switch (item->type) {
-            case ASYNC_UPDATE_PROPERTY:
-                //property update
-                {
-                    AsyncPropertyUpdate *propItem = static_cast<AsyncPropertyUpdate *>(item);
+        asyncQueueLock.unlock();
 
-                    //call local handler
-                    base_js_assert(propItem->property);
-                    base_js_assert(propItem->property->obj);
+        if (count == 0) {
+            break;
+        }
 
-                    if (DEBUG_ASYNC) {
-                        printf("%i of %i (property: %s of %s)\n", (int)i, (int)asyncUpdates->size(), propItem->property->name.c_str(), propItem->property->obj->getName().c_str());
-                    }
+        //iterate
+        for (std::size_t i = 0; i < count; i++) {
+            AnyAsyncUpdate *item = (*asyncProcessing)[i];
 
-                    propItem->property->obj->handleAsyncUpdate(propItem);
-                }
-                break;
+            //coalesced
+            if (!item) {
+                continue;
+            }
 
-            case ASYNC_UPDATE_VALUE:
-                //custom value update
-                {
-                    AsyncValueUpdate *valueItem = static_cast<AsyncValueUpdate *>(item);
+            //debug
+            //printf("%i of %i (type: %i)\n", (int)i, (int)count, (int)item->type);
 
-                    //call local handler
-                    base_js_assert(valueItem->obj);
+            switch (item->type) {
+                case ASYNC_UPDATE_PROPERTY:
+                    //property update
+                    {
+                        AsyncPropertyUpdate *propItem = static_cast<AsyncPropertyUpdate *>(item);
 
-                    if (DEBUG_ASYNC) {
-                        printf("%i of %i (type: value update)\n", (int)i, (int)asyncUpdates->size());
+                        //call local handler
+                        base_js_assert(propItem->property);
+                        base_js_assert(propItem->property->obj);
+
+                        if (DEBUG_ASYNC) {
+                            printf("%i of %i (property: %s of %s)\n", (int)i, (int)count, propItem->property->name.c_str(), propItem->property->obj->getName().c_str());
+                        }
+
+                        propItem->property->obj->handleAsyncUpdate(propItem);
                     }
+                    break;
+
+                case ASYNC_UPDATE_VALUE:
+                    //custom value update
+                    {
+                        AsyncValueUpdate *valueItem = static_cast<AsyncValueUpdate *>(item);
 
-                    if (!valueItem->obj->handleAsyncUpdate(valueItem)) {
-                        std::string name = valueItem->obj->getName();
+                        //call local handler
+                        base_js_assert(valueItem->obj);
 
-                        printf("unhandled async update by %s\n", name.c_str());
+                        if (DEBUG_ASYNC) {
+                            printf("%i of %i (type: value update)\n", (int)i, (int)count);
+                        }
+
+                        if (!valueItem->obj->handleAsyncUpdate(valueItem)) {
+                            std::string name = valueItem->obj->getName();
+
+                            printf("unhandled async update by %s\n", name.c_str());
+                        }
                     }
-                }
-                break;
+                    break;
 
-            default:
-                printf("unknown async type: %i\n", item->type);
-                base_js_assert(false);
-                break;
+                default:
+                    printf("unknown async type: %i\n", item->type);
+                    base_js_assert(false);
+                    break;
+            }
         }
 
-        //free item
-        asyncDeletes->push_back(item);
-    }
+        //free items on main thread
+        asyncLock.lock();
 
-    //clear
-    asyncUpdates->clear();
+        for (auto const &item : *asyncProcessing) {
+            if (item) {
+                asyncDeletes->push_back(item);
+            }
+        }
 
-    asyncLock.unlock();
-    // base_js_assert(res == 0);
+        asyncLock.unlock();
+
+        asyncProcessing->clear();
+        processed = true;
+    }
 
     if (DEBUG_BASE) {
         printf("--- processAsyncQueue() done --- \n");
     }
+
+    return processed;
+}
+
+/**
+ * New updates were added to the async queue.
+ *
+ * Note: can be called on any thread.
+ */
+void AminoJSEventObject::asyncUpdatesAvailable() {
+    //empty: overwrite
 }
 
 /**
@@ -2300,16 +2909,9 @@ bool AminoJSEventObject::enqueueValueUpdate(AsyncValueUpdate *update) {
         printf("enqueueValueUpdate\n");
     }
 
-    base_js_assert(asyncUpdates);
+    AnyAsyncUpdate *item = update;
 
-    asyncLock.lock();
-
-    // base_js_assert(res == 0);
-
-    asyncUpdates->push_back(update);
-
-    asyncLock.unlock();
-    // base_js_assert(res == 0);
+    pushAsyncUpdates(&item, 1);
 
     return true;
 }
@@ -2324,14 +2926,37 @@ bool AminoJSEventObject::enqueuePropertyUpdate(AnyProperty *prop, v8::Local<v8::
         return false;
     }
 
-    base_js_assert(prop);
-
     //create
     bool valid = false;
+    AsyncPropertyUpdate *update = createPropertyUpdate(prop, value, valid);
+
+    if (!update) {
+        //invalid or sync update
+        return valid;
+    }
+
+    //async handling
+    AnyAsyncUpdate *item = update;
+
+    pushAsyncUpdates(&item, 1);
+
+    return true;
+}
+
+/**
+ * Create an async property update.
+ *
+ * Returns NULL if the value is invalid or was handled on the main thread (valid is true).
+ */
+AminoJSObject::AsyncPropertyUpdate *AminoJSEventObject::createPropertyUpdate(AnyProperty *prop, v8::Local<v8::Value> &value, bool &valid) {
+    base_js_assert(prop);
+
+    valid = false;
+
     void *data = prop->getAsyncData(value, valid);
 
     if (!valid) {
-        return false;
+        return NULL;
     }
 
     //call sync handler
@@ -2346,27 +2971,124 @@ bool AminoJSEventObject::enqueuePropertyUpdate(AnyProperty *prop, v8::Local<v8::
 
         prop->freeAsyncData(data);
 
-        return true;
+        return NULL;
     }
 
-    //async handling
-    asyncLock.lock();
+    return new (&updatePool) AsyncPropertyUpdate(prop, data);
+}
 
-    // base_js_assert(res == 0);
+/**
+ * Enqueue multiple updates (single lock).
+ *
+ * Note: the updates are owned by the queue afterwards.
+ */
+void AminoJSEventObject::enqueuePropertyUpdates(std::vector<AnyAsyncUpdate *> &updates) {
+    if (updates.empty()) {
+        return;
+    }
 
-    asyncUpdates->push_back(new AsyncPropertyUpdate(prop, data));
+    if (destroyed) {
+        for (auto const &update : updates) {
+            delete update;
+        }
 
-    asyncLock.unlock();
-    // base_js_assert(res == 0);
+        updates.clear();
 
-    return true;
+        return;
+    }
+
+    pushAsyncUpdates(updates.data(), updates.size());
+
+    updates.clear();
+}
+
+/**
+ * Add items to the async queue.
+ *
+ * A queued update of the same property is replaced (only the last value of a frame is applied). Property updates are
+ * not moved across value updates.
+ *
+ * Note: thread-safe. The rendering thread only holds the queue lock to swap the buffers.
+ */
+void AminoJSEventObject::pushAsyncUpdates(AnyAsyncUpdate * const *items, std::size_t count) {
+    base_js_assert(asyncUpdates);
+
+    auto startTime = std::chrono::steady_clock::now();
+
+    asyncQueueLock.lock();
+
+    double wait = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+    for (std::size_t i = 0; i < count; i++) {
+        AnyAsyncUpdate *item = items[i];
+
+        if (item->type == ASYNC_UPDATE_PROPERTY) {
+            AnyProperty *property = item->property;
+
+            if (property->asyncGeneration == asyncGeneration) {
+                //coalesce (keep position of last write)
+                AnyAsyncUpdate *replaced = (*asyncUpdates)[property->asyncIndex];
+
+                property->mergeAsyncData(static_cast<AsyncPropertyUpdate *>(item)->data, static_cast<AsyncPropertyUpdate *>(replaced)->data);
+                asyncReplaced.push_back(replaced);
+                (*asyncUpdates)[property->asyncIndex] = NULL;
+            }
+
+            property->asyncGeneration = asyncGeneration;
+            property->asyncIndex = asyncUpdates->size();
+        } else {
+            //keep order
+            resetAsyncPending();
+        }
+
+        asyncUpdates->push_back(item);
+    }
+
+    //take replaced items (only the ones added by this call)
+    std::vector<AnyAsyncUpdate *> replaced;
+
+    if (!asyncReplaced.empty()) {
+        replaced.swap(asyncReplaced);
+    }
+
+    //stats
+    asyncEnqueued += count;
+    asyncCoalesced += replaced.size();
+    asyncWaitTime += wait;
+
+    if (wait > asyncMaxWait) {
+        asyncMaxWait = wait;
+    }
+
+    asyncQueueLock.unlock();
+
+    //free replaced items (Note: property updates are only added on main thread)
+    for (auto const &item : replaced) {
+        delete item;
+    }
+
+    asyncUpdatesAvailable();
+}
+
+/**
+ * Forget the queued property updates (new updates are appended).
+ *
+ * Note: asyncQueueLock has to be locked.
+ */
+void AminoJSEventObject::resetAsyncPending() {
+    asyncGeneration++;
+
+    if (asyncGeneration == 0) {
+        //skip initial value of properties
+        asyncGeneration = 1;
+    }
 }
 
 /**
  * Add JS property update.
  */
 bool AminoJSEventObject::enqueueJSPropertyUpdate(AnyProperty *prop) {
-    return enqueueJSUpdate(new JSPropertyUpdate(prop));
+    return enqueueJSUpdate(new (&updatePool) JSPropertyUpdate(prop));
 }
 
 void AminoJSEventObject::propertyDeleted(AnyProperty* prop) {
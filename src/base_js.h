@@ -7,6 +7,7 @@
 
 #include <map>
 #include <set>
+#include <vector>
 #include <memory>
 #ifndef WIN
 #include <pthread.h>
@@ -30,6 +31,60 @@ typedef unsigned short ushort;
 
 class AminoJSObject;
 
+/**
+ * Float32Array shared with JS (zero-copy; the backing store outlives a detached buffer).
+ */
+struct amino_float_view_t {
+#if V8_MAJOR_VERSION >= 8
+    std::shared_ptr<v8::BackingStore> store;
+#else
+    //Note: no backing store API, buffer could get detached
+    std::vector<float> copy;
+#endif
+    const void *source = NULL; //JS buffer
+    float *data = NULL;
+    std::size_t size = 0;
+
+    //changed range (in floats)
+    bool changedAll = true;
+    std::size_t changedStart = 0;
+    std::size_t changedEnd = 0;
+};
+
+/**
+ * Free-list allocator for async update records and their data.
+ *
+ * Blocks are kept in size classes and can be freed on any thread. Each block stores its pool (NULL: heap block).
+ */
+class AminoUpdatePool {
+public:
+    AminoUpdatePool();
+    ~AminoUpdatePool();
+
+    static void* allocBlock(AminoUpdatePool *pool, std::size_t size);
+    static void freeBlock(void *ptr);
+
+    static std::vector<float>* allocFloatVector(AminoUpdatePool *pool);
+    static void freeFloatVector(std::vector<float> *vector);
+
+    void getStats(v8::Local<v8::Object> &obj);
+
+private:
+    static const std::size_t BLOCK_SIZE = 16;
+    static const std::size_t CLASS_COUNT = 16; //up to 256 bytes
+
+    std::mutex lock;
+    std::vector<void *> blocks[CLASS_COUNT];
+    std::vector<std::vector<float> *> floatVectors;
+
+    //stats
+    uint32_t heapAllocs = 0;
+    uint32_t poolAllocs = 0;
+
+    void recycle(void *block, std::size_t sizeClass);
+    bool recycleFloatVector(std::vector<float> *vector);
+};
+
 /**
  * Factory object to create JS instance.
  */
@@ -95,6 +150,10 @@ protected:
         uint32_t id;
         bool connected = false;
 
+        //queued async update (see AminoJSEventObject::pushAsyncUpdates())
+        uint32_t asyncGeneration = 0;
+        std::size_t asyncIndex = 0;
+
         AnyProperty(int32_t type, AminoJSObject *obj, std::string name, uint32_t id);
         virtual ~AnyProperty();
 
@@ -107,10 +166,13 @@ protected:
         virtual void* getAsyncData(v8::Local<v8::Value> &value, bool &valid) = 0;
         virtual void setAsyncData(AsyncPropertyUpdate *update, void *data) = 0;
         virtual void freeAsyncData(void *data) = 0;
+        virtual void mergeAsyncData(void *data, void *oldData);
 
         //weak reference control (obj)
         void retain();
         void release();
+
+        AminoUpdatePool* getUpdatePool();
     };
 
     class FloatProperty : public AnyProperty {
@@ -137,11 +199,23 @@ protected:
     public:
         std::vector<float> value;
 
+        //zero-copy mode (Float32Array values are not copied; copied on V8 < 8)
+        bool shared = false;
+        amino_float_view_t *view = NULL;
+
         FloatArrayProperty(AminoJSObject *obj, std::string name, uint32_t id);
         ~FloatArrayProperty();
 
         void setValue(std::vector<float> newValue);
 
+        float* getData();
+        std::size_t getSize();
+
+        //changed range (main thread: next update; rendering thread: since last upload)
+        void setNextRange(std::size_t start, std::size_t count);
+        bool getChangedRange(std::size_t &start, std::size_t &end);
+        void clearChangedRange();
+
         std::string toString() override;
 
         //sync handling
@@ -151,6 +225,19 @@ protected:
         void* getAsyncData(v8::Local<v8::Value> &value, bool &valid) override;
         void setAsyncData(AsyncPropertyUpdate *update, void *data) override;
         void freeAsyncData(void *data) override;
+        void mergeAsyncData(void *data, void *oldData) override;
+
+    private:
+        bool hasNextRange = false;
+        std::size_t nextStart = 0;
+        std::size_t nextEnd = 0;
+
+        bool changedAll = true;
+        std::size_t changedStart = 0;
+        std::size_t changedEnd = 0;
+
+        amino_float_view_t* createView(v8::Local<v8::Float32Array> arr);
+        static void freeView(amino_float_view_t *view);
     };
 
     class DoubleProperty : public AnyProperty {
@@ -322,6 +409,12 @@ protected:
         virtual ~AnyAsyncUpdate();
 
         virtual void apply() = 0;
+
+        //pooled allocation
+        static void* operator new(std::size_t size);
+        static void* operator new(std::size_t size, AminoUpdatePool *pool);
+        static void operator delete(void *ptr);
+        static void operator delete(void *ptr, AminoUpdatePool *pool);
     };
 
     class AsyncPropertyUpdate : public AnyAsyncUpdate {
@@ -422,6 +515,13 @@ private:
     virtual bool enqueueJSPropertyUpdate(AnyProperty *prop);
 
 public:
+    //batched property updates
+    static const uint32_t BATCH_RECORD_SIZE  = 4;
+    static const uint32_t BATCH_VALUE_NUMBER = 0;
+    static const uint32_t BATCH_VALUE_BOOL   = 1;
+    static const uint32_t BATCH_VALUE_OTHER  = 2;
+
+    static NAN_METHOD(PropertiesUpdated);
 
     std::string getName();
 
@@ -433,6 +533,7 @@ public:
     AnyProperty* getPropertyWithName(std::string name);
 
     virtual AminoJSEventObject* getEventHandler();
+    AminoUpdatePool* getUpdatePool();
 
     virtual bool handleSyncUpdate(AnyProperty *property, void *data);
     virtual void handleAsyncUpdate(AsyncPropertyUpdate *update);
@@ -450,6 +551,8 @@ public:
     AminoJSEventObject* getEventHandler() override;
 
     bool enqueuePropertyUpdate(AnyProperty *prop, v8::Local<v8::Value> &value);
+    AsyncPropertyUpdate *createPropertyUpdate(AnyProperty *prop, v8::Local<v8::Value> &value, bool &valid);
+    void enqueuePropertyUpdates(std::vector<AnyAsyncUpdate *> &updates);
     bool enqueueValueUpdate(AsyncValueUpdate *update) override;
 
     bool enqueueJSPropertyUpdate(AnyProperty *prop) override;
@@ -459,9 +562,12 @@ public:
 
     bool isMainThread();
 
+    AminoUpdatePool updatePool;
+
 protected:
     bool isEventHandler() override;
-    void processAsyncQueue();
+    bool processAsyncQueue();
+    virtual void asyncUpdatesAvailable();
     void clearAsyncQueue();
     void handleAsyncDeletes();
     void handleJSUpdates();
@@ -469,13 +575,29 @@ protected:
     virtual void getStats(v8::Local<v8::Object> &obj);
 
 private:
+    //async queue (double buffered: filled by producers, swapped and drained by rendering thread)
     std::vector<AnyAsyncUpdate *> *asyncUpdates = NULL;
+    std::vector<AnyAsyncUpdate *> *asyncProcessing = NULL;
+    std::mutex asyncQueueLock; //Note: only held to add items or swap the buffers
+    uint32_t asyncGeneration = 1; //queued property updates (see AnyProperty::asyncGeneration)
+    std::vector<AnyAsyncUpdate *> asyncReplaced; //Note: emptied before asyncQueueLock is released
+
     std::vector<AnyAsyncUpdate *> *asyncDeletes = NULL;
     std::vector<AnyAsyncUpdate *> *jsUpdates = NULL;
     std::set<AnyProperty*> deletedProps;
 
     std::thread::id mainThread;
-    std::recursive_mutex asyncLock; //Note: can block for a while
+    std::recursive_mutex asyncLock; //guards asyncDeletes, jsUpdates and deletedProps
+
+    //async queue stats
+    uint32_t asyncMaxDepth = 0;
+    uint32_t asyncEnqueued = 0;
+    uint32_t asyncCoalesced = 0;
+    double asyncWaitTime = 0; //ms
+    double asyncMaxWait = 0; //ms
+
+    void pushAsyncUpdates(AnyAsyncUpdate * const *items, std::size_t count);
+    void resetAsyncPending();
 };
 
 #endif
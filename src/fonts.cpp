@@ -5,9 +5,34 @@
 #include "base.h"
 
 #include <cmath>
+#include <cstring>
+#include <cwctype>
+#include <algorithm>
+#include <cstdio>
+
+#ifndef WIN
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 
 #define DEBUG_FONTS false
 
+//atlas page size (pixels)
+#define ATLAS_PAGE_SIZE 1024
+
+//base size of signed distance field glyphs (pixels)
+#define SDF_FONT_SIZE 48
+
+//default atlas limits (pages per font; 0: no eviction)
+#define ATLAS_MAX_PAGES 4
+#define ATLAS_EVICT_FRAMES 0
+
+//glyph cache file (format version; minimum time between writes in ms)
+#define FONT_CACHE_VERSION 1
+#define FONT_CACHE_SAVE_INTERVAL 5000
+
 //
 // AminoFonts
 //
@@ -108,6 +133,36 @@ void AminoFont::destroy() {
  * Destroy font data.
  */
 void AminoFont::destroyAminoFont() {
+    //glyph cache
+    saveCache();
+
+    glyphLock.lock();
+
+    //cached layouts
+    AminoText::layoutCache.removeFont(this);
+
+    //glyphs
+    freeGlyphs();
+
+    glyphLock.unlock();
+
+    //instance
+    std::vector<AminoFont *>::iterator it = std::find(instances.begin(), instances.end(), this);
+
+    if (it != instances.end()) {
+        instances.erase(it);
+    }
+
+    //font data
+    fontData.Reset();
+}
+
+/**
+ * Free all font sizes and atlas pages.
+ *
+ * Note: glyphLock has to be locked.
+ */
+void AminoFont::freeGlyphs() {
     //font sizes
     for (std::map<uint32_t, texture_font_t *>::iterator it = fontSizes.begin(); it != fontSizes.end(); it++) {
         texture_font_delete(it->second);
@@ -115,14 +170,22 @@ void AminoFont::destroyAminoFont() {
 
     fontSizes.clear();
 
-    //atlas
-    if (atlas) {
-        texture_atlas_delete(atlas);
-        atlas = NULL;
+    if (sdfFont) {
+        texture_font_delete(sdfFont);
+        sdfFont = NULL;
     }
 
-    //font data
-    fontData.Reset();
+    //atlas pages
+    for (auto const &page : atlasPages) {
+        texture_atlas_delete(page->atlas);
+        delete page;
+    }
+
+    atlasPages.clear();
+
+    //cached bitmaps have to be written again
+    cachePages.clear();
+    cacheVersions.clear();
 }
 
 /**
@@ -175,14 +238,29 @@ void AminoFont::preInit(Nan::NAN_METHOD_ARGS_TYPE info) {
 
     this->fontData.Reset(bufferObj);
 
-    //create atlas
-    atlas = texture_atlas_new(1024, 1024, 1); //depth must be 1
+    //restore glyphs
+    if (!cacheDir.empty()) {
+        const uint8_t *data = (const uint8_t *)node::Buffer::Data(bufferObj);
+        size_t len = node::Buffer::Length(bufferObj);
 
-    if (!atlas) {
+        //FNV-1a
+        fontHash = 14695981039346656037ULL;
+
+        for (size_t i = 0; i < len; i++) {
+            fontHash = (fontHash ^ data[i]) * 1099511628211ULL;
+        }
+
+        loadCache();
+    }
+
+    //create atlas
+    if (atlasPages.empty() && !addAtlasPage()) {
         Nan::ThrowTypeError("could not create atlas");
         return;
     }
 
+    instances.push_back(this);
+
     //metadata
     v8::Local<v8::Value> nameValue = Nan::Get(fontData, Nan::New<v8::String>("name").ToLocalChecked()).ToLocalChecked();
     v8::Local<v8::Value> styleValue = Nan::Get(fontData, Nan::New<v8::String>("style").ToLocalChecked()).ToLocalChecked();
@@ -208,20 +286,16 @@ texture_font_t *AminoFont::getFontWithSize(uint32_t size) {
 
     if (it == fontSizes.end()) {
         //add new size
-        v8::Local<v8::Object> bufferObj = Nan::New(fontData);
-        char *buffer = node::Buffer::Data(bufferObj);
-        size_t bufferLen = node::Buffer::Length(bufferObj);
+        glyphLock.lock();
 
-        //Note: has texture id but we use our own handling
-        fontSize = texture_font_new_from_memory(atlas, size, buffer, bufferLen, library);
+        fontSize = createFont(size);
 
         if (fontSize) {
             fontSizes[size] = fontSize;
-
-            //use single FreeType instance
-            library = fontSize->library;
         }
 
+        glyphLock.unlock();
+
         if (DEBUG_FONTS) {
             std::string info = getFontInfo();
 
@@ -235,259 +309,1351 @@ texture_font_t *AminoFont::getFontWithSize(uint32_t size) {
 }
 
 /**
- * Get Unique font info string.
- */
-std::string AminoFont::getFontInfo() {
-    return fontName + "/" + fontStyle + "/" + std::to_string(fontWeight);
-}
-
-FT_Library AminoFont::library = NULL;
-
-//
-//  AminoFontFactory
-//
-
-/**
- * Create AminoFont factory.
+ * Get the signed distance field font (shared by all sizes).
+ *
+ * Note: has to be called in v8 thread.
  */
-AminoFontFactory::AminoFontFactory(Nan::FunctionCallback callback): AminoJSObjectFactory("AminoFont", callback) {
-    //empty
-}
+texture_font_t *AminoFont::getSdfFont() {
+    if (!sdfFont) {
+        std::lock_guard<std::mutex> lock(glyphLock);
 
-/**
- * Create AminoFonts instance.
- */
-AminoJSObject* AminoFontFactory::create() {
-    return new AminoFont();
-}
+        texture_font_t *font = createFont(SDF_FONT_SIZE);
 
-//
-// AminoFontSize
-//
+        if (font) {
+            font->rendermode = RENDER_SIGNED_DISTANCE_FIELD;
+        }
 
-AminoFontSize::AminoFontSize(): AminoJSObject(getFactory()->name) {
-    //empty
-}
+        sdfFont = font;
+    }
 
-AminoFontSize::~AminoFontSize() {
-    //empty
+    return sdfFont;
 }
 
 /**
- * Get factory instance.
+ * Create a font instance.
+ *
+ * The glyphs are stored on the last atlas page by default.
+ *
+ * Note: has to be called in v8 thread (glyphLock locked).
  */
-AminoFontSizeFactory* AminoFontSize::getFactory() {
-    static AminoFontSizeFactory *aminoFontSizeFactory = NULL;
+texture_font_t *AminoFont::createFont(float size, texture_atlas_t *atlas) {
+    v8::Local<v8::Object> bufferObj = Nan::New(fontData);
+    char *buffer = node::Buffer::Data(bufferObj);
+    size_t bufferLen = node::Buffer::Length(bufferObj);
 
-    if (!aminoFontSizeFactory) {
-        aminoFontSizeFactory = new AminoFontSizeFactory(New);
+    if (!atlas) {
+        atlas = atlasPages.back()->atlas;
     }
 
-    return aminoFontSizeFactory;
-}
+    //Note: has texture id but we use our own handling
+    texture_font_t *fontSize = texture_font_new_from_memory(atlas, size, buffer, bufferLen, library);
 
-/**
- * Initialize AminoFontSize template.
- */
-v8::Local<v8::FunctionTemplate> AminoFontSize::GetInitFunction() {
-    v8::Local<v8::FunctionTemplate> tpl = AminoJSObject::createTemplate(getFactory());
+    if (fontSize) {
+        //continue on other pages if full
+        fontSize->atlas_full = atlasFull;
+        fontSize->atlas_full_data = this;
 
-    //methods
-    Nan::SetPrototypeMethod(tpl, "_calcTextWidth", CalcTextWidth);
-    Nan::SetPrototypeMethod(tpl, "getFontMetrics", GetFontMetrics);
+        //use single FreeType instance
+        library = fontSize->library;
+    }
 
-    //template function
-    return tpl;
+    return fontSize;
 }
 
 /**
- * JS object construction.
+ * Get Unique font info string.
  */
-NAN_METHOD(AminoFontSize::New) {
-    AminoJSObject::createInstance(info, getFactory());
+std::string AminoFont::getFontInfo() {
+    return fontName + "/" + fontStyle + "/" + std::to_string(fontWeight);
 }
 
 /**
- * Initialize constructor values.
+ * Add an empty atlas page.
  */
-void AminoFontSize::preInit(Nan::NAN_METHOD_ARGS_TYPE info) {
-    assert(info.Length() == 2);
+amino_atlas_page_t *AminoFont::addAtlasPage() {
+    texture_atlas_t *atlas = texture_atlas_new(ATLAS_PAGE_SIZE, ATLAS_PAGE_SIZE, 1); //depth must be 1
 
-    AminoFont *font = Nan::ObjectWrap::Unwrap<AminoFont>(Nan::To<v8::Object>(info[0]).ToLocalChecked());
-    uint32_t size = Nan::To<v8::Uint32>(info[1]).ToLocalChecked()->Value();
+    if (!atlas) {
+        return NULL;
+    }
 
-    assert(font);
+    amino_atlas_page_t *page = new amino_atlas_page_t();
 
-    this->font = font;
-    fontTexture = font->getFontWithSize(size);
+    page->font = this;
+    page->atlas = atlas;
+    page->lastUsed = frame.load();
 
-    if (!fontTexture) {
-        Nan::ThrowTypeError("could not create font size");
-    }
+    atlas->user_data = page;
 
-    //font properties
-    v8::Local<v8::Object> obj = handle();
+    atlasPages.push_back(page);
 
-    Nan::Set(obj, Nan::New("name").ToLocalChecked(), Nan::New<v8::String>(font->fontName).ToLocalChecked());
-    Nan::Set(obj, Nan::New("size").ToLocalChecked(), Nan::New<v8::Number>(size));
-    Nan::Set(obj, Nan::New("weight").ToLocalChecked(), Nan::New<v8::Number>(font->fontWeight));
-    Nan::Set(obj, Nan::New("style").ToLocalChecked(), Nan::New<v8::String>(font->fontStyle).ToLocalChecked());
+    if (DEBUG_FONTS) {
+        printf("-> new atlas page: %i (%s)\n", (int)atlasPages.size(), getFontInfo().c_str());
+    }
+
+    return page;
 }
 
 /**
- * Calculate text width.
+ * Get the page of an atlas.
+ *
+ * Note: glyphLock has to be locked.
  */
-NAN_METHOD(AminoFontSize::CalcTextWidth) {
-    assert(info.Length() == 1);
+amino_atlas_page_t *AminoFont::getAtlasPage(texture_atlas_t *atlas) {
+    for (auto const &page : atlasPages) {
+        if (page->atlas == atlas) {
+            return page;
+        }
+    }
 
-    AminoFontSize *obj = Nan::ObjectWrap::Unwrap<AminoFontSize>(info.This());
-    Nan::Utf8String str(info[0]);
+    return NULL;
+}
 
-    assert(obj);
+/**
+ * Atlas of a font size is full.
+ *
+ * Note: called by texture_font_load_glyph() (glyphLock locked).
+ */
+texture_atlas_t *AminoFont::atlasFull(texture_font_t *fontSize, void *data) {
+    AminoFont *font = static_cast<AminoFont *>(data);
 
-    info.GetReturnValue().Set(obj->getTextWidth(*str));
+    return font->nextAtlasPage(fontSize);
 }
 
 /**
- * Calculate text width.
+ * Get the next atlas page to store glyphs in.
+ *
+ * Order: following page, new page, least recently used page (if not used in the last frames).
  */
-float AminoFontSize::getTextWidth(const char *text) {
-    size_t len = utf8_strlen(text);
-    char *textPos = (char *)text;
-    char *lastTextPos = NULL;
-    float w = 0;
+texture_atlas_t *AminoFont::nextAtlasPage(texture_font_t *fontSize) {
+    //following page
+    std::size_t count = atlasPages.size();
 
-    AminoText::initFreeTypeMutex();
-    uv_mutex_lock(&AminoText::freeTypeMutex);
-
-    size_t lastGlyphCount = fontTexture->glyphs->size;
+    for (std::size_t i = 0; i + 1 < count; i++) {
+        if (atlasPages[i]->atlas == fontSize->atlas) {
+            return atlasPages[i + 1]->atlas;
+        }
+    }
 
-    for (std::size_t i = 0; i < len; i++) {
-        texture_glyph_t *glyph = texture_font_get_glyph(fontTexture, textPos);
+    //new page
+    if (count < maxAtlasPages) {
+        amino_atlas_page_t *page = addAtlasPage();
 
-        if (!glyph) {
-            printf("Error: got empty glyph from texture_font_get_glyph()\n");
-            continue;
+        if (page) {
+            return page->atlas;
         }
+    }
 
-        //kerning
-        if (lastTextPos) {
-            w += texture_glyph_get_kerning(glyph, lastTextPos);
-        }
+    //evict least recently used page
+    if (atlasEvictFrames > 0) {
+        uint32_t now = frame.load();
+        amino_atlas_page_t *lru = NULL;
+        uint32_t lruAge = 0;
 
-        //char width
-        w += glyph->advance_x;
+        for (auto const &page : atlasPages) {
+            uint32_t age = now - page->lastUsed.load();
 
-        //next
-        size_t charLen = utf8_surrogate_len(textPos);
+            if (age > atlasEvictFrames && age > lruAge) {
+                lru = page;
+                lruAge = age;
+            }
+        }
 
-        lastTextPos = textPos;
-        textPos += charLen;
+        if (lru) {
+            evictAtlasPage(lru);
+
+            return lru->atlas;
+        }
     }
 
-    bool glyphsChanged = lastGlyphCount != fontTexture->glyphs->size;
+    return NULL;
+}
+
+/**
+ * Clear an atlas page and remove its glyphs from all font sizes.
+ *
+ * Texts using the page are laid out again before they are rendered next time.
+ */
+void AminoFont::evictAtlasPage(amino_atlas_page_t *page) {
+    size_t removed = 0;
 
-    uv_mutex_unlock(&AminoText::freeTypeMutex);
+    texture_atlas_clear(page->atlas);
 
-    if (glyphsChanged) {
-        texture_atlas_t *atlas = fontTexture->atlas;
+    for (auto const &item : fontSizes) {
+        removed += texture_font_remove_glyphs(item.second, page->atlas);
+    }
 
-        //update all instances
-        AminoGfx::updateAtlasTextures(atlas);
+    if (sdfFont) {
+        removed += texture_font_remove_glyphs(sdfFont, page->atlas);
     }
 
-    return w;
+    page->lastUsed = frame.load();
+    page->evictions++;
+    atlasEvictions++;
+
+    if (DEBUG_FONTS) {
+        printf("-> evicted atlas page: %i glyphs (%s)\n", (int)removed, getFontInfo().c_str());
+    }
 }
 
 /**
- * Get font metrics (height, ascender, descender).
+ * Next frame was rendered.
+ *
+ * Note: used to find least recently used atlas pages.
  */
-NAN_METHOD(AminoFontSize::GetFontMetrics) {
-    AminoFontSize *obj = Nan::ObjectWrap::Unwrap<AminoFontSize>(info.This());
-
-    assert(obj);
-
-    //metrics
-    v8::Local<v8::Object> metricsObj = Nan::New<v8::Object>();
+void AminoFont::nextFrame() {
+    frame++;
+}
 
-    Nan::Set(metricsObj, Nan::New("height").ToLocalChecked(), Nan::New<v8::Number>(obj->fontTexture->ascender - obj->fontTexture->descender));
-    Nan::Set(metricsObj, Nan::New("ascender").ToLocalChecked(), Nan::New<v8::Number>(obj->fontTexture->ascender));
-    Nan::Set(metricsObj, Nan::New("descender").ToLocalChecked(), Nan::New<v8::Number>(obj->fontTexture->descender));
+/**
+ * Get the frame counter.
+ */
+uint32_t AminoFont::getFrame() {
+    return frame.load();
+}
 
-    info.GetReturnValue().Set(metricsObj);
+/**
+ * Get the number of evicted atlas pages.
+ */
+uint32_t AminoFont::getAtlasEvictions() {
+    return atlasEvictions.load();
 }
 
-//
-//  AminoFontSizeFactory
-//
+/**
+ * Set the maximum number of atlas pages per font.
+ */
+void AminoFont::setMaxAtlasPages(uint32_t pages) {
+    maxAtlasPages = std::max(pages, (uint32_t)1);
+}
 
 /**
- * Create AminoFontSize factory.
+ * Evict atlas pages not used in the given number of frames if no page is left (0: disabled).
  */
-AminoFontSizeFactory::AminoFontSizeFactory(Nan::FunctionCallback callback): AminoJSObjectFactory("AminoFontSize", callback) {
-    //empty
+void AminoFont::setAtlasEvictFrames(uint32_t frames) {
+    atlasEvictFrames = frames;
 }
 
 /**
- * Create AminoFonts instance.
+ * Get the atlas statistics of all fonts.
  */
-AminoJSObject* AminoFontSizeFactory::create() {
-    return new AminoFontSize();
+void AminoFont::getAtlasStats(v8::Local<v8::Object> &obj) {
+    uint32_t pages = 0;
+    double used = 0;
+    double size = 0;
+
+    for (auto const &font : instances) {
+        std::lock_guard<std::mutex> lock(font->glyphLock);
+
+        for (auto const &page : font->atlasPages) {
+            pages++;
+            used += page->atlas->used;
+            size += page->atlas->width * page->atlas->height;
+        }
+    }
+
+    uint32_t evictions = atlasEvictions.load();
+
+    v8::Local<v8::Object> atlasObj = Nan::New<v8::Object>();
+
+    Nan::Set(atlasObj, Nan::New("pages").ToLocalChecked(), Nan::New(pages));
+    Nan::Set(atlasObj, Nan::New("occupancy").ToLocalChecked(), Nan::New(size > 0 ? used / size:0));
+    Nan::Set(atlasObj, Nan::New("evictions").ToLocalChecked(), Nan::New(evictions));
+    Nan::Set(obj, Nan::New("atlas").ToLocalChecked(), atlasObj);
 }
 
-//
-// AminoFontShader
-//
+/**
+ * Load the glyphs of a font size in advance.
+ *
+ * Modified atlases are added to atlases. Returns the number of glyphs which could not be stored.
+ */
+uint32_t AminoFont::loadGlyphs(texture_font_t *fontSize, const char *codepoints, std::size_t length, std::vector<texture_atlas_t *> &atlases) {
+    std::lock_guard<std::mutex> lock(glyphLock);
 
-AminoFontShader::AminoFontShader() : TextureShader() {
-    //shader
+    //atlas versions
+    std::vector<uint32_t> versions;
 
-    //Note: using unmodified vertex shader
-    fragmentShader = R"(
-        #ifdef GL_ES
-            precision mediump float;
-        #endif
+    for (auto const &page : atlasPages) {
+        versions.push_back(page->atlas->version);
+    }
 
-        uniform float opacity;
-        uniform vec3 color;
-        uniform sampler2D tex;
+    //Note: texture_font_load_glyphs() stops at the first missing glyph
+    uint32_t missing = 0;
 
-        varying vec2 uv;
+    //Note: the string may contain NUL characters
+    const char *end = codepoints + length;
+    std::size_t len;
 
-        void main() {
-            float a = texture2D(tex, uv).a;
+    for (const char *pos = codepoints; pos < end; pos += len) {
+        len = utf8_surrogate_len(pos);
 
-            gl_FragColor = vec4(color, opacity * a);
+        if (len == 0 || pos + len > end) {
+            break;
         }
-    )";
+
+        if (*pos == 0) {
+            continue;
+        }
+
+        if (!texture_font_load_glyph(fontSize, pos)) {
+            missing++;
+        }
+    }
+
+    //modified pages (used by preloaded glyphs)
+    uint32_t now = frame.load();
+
+    for (std::size_t i = 0; i < atlasPages.size(); i++) {
+        amino_atlas_page_t *page = atlasPages[i];
+
+        if (i >= versions.size() || page->atlas->version != versions[i]) {
+            atlases.push_back(page->atlas);
+            page->lastUsed = now;
+        }
+    }
+
+    return missing;
 }
 
 /**
- * Initialize the font shader.
+ * Append a value to the glyph cache data.
  */
-void AminoFontShader::initShader() {
-    TextureShader::initShader();
+template<typename T> static void appendCacheValue(std::vector<uint8_t> &data, T value) {
+    uint8_t *bytes = (uint8_t *)&value;
 
-    //uniforms
-    uColor = getUniformLocation("color");
+    data.insert(data.end(), bytes, bytes + sizeof(T));
 }
 
 /**
- * Set color.
+ * Read a value of the glyph cache data.
+ *
+ * Returns false if the end of the data was reached.
  */
-void AminoFontShader::setColor(GLfloat color[3]) {
-    glUniform3f(uColor, color[0], color[1], color[2]);
+template<typename T> static bool readCacheValue(const uint8_t *&pos, const uint8_t *end, T &value) {
+    if ((size_t)(end - pos) < sizeof(T)) {
+        return false;
+    }
+
+    std::memcpy(&value, pos, sizeof(T));
+    pos += sizeof(T);
+
+    return true;
 }
 
 /**
- * Get texture for atlas.
+ * Set the directory of the glyph cache files (empty: disabled).
  *
- * Note: has to be called on OpenGL thread.
+ * Note: fonts loaded afterwards restore their glyphs from the cache.
  */
-amino_atlas_t AminoFontShader::getAtlasTexture(texture_atlas_t *atlas, bool createIfMissing, bool &newTexture) {
-    std::map<texture_atlas_t *, amino_atlas_t>::iterator it = atlasTextures.find(atlas);
-
-    newTexture = false;
+void AminoFont::setCacheDir(std::string dir) {
+    cacheDir = dir;
+}
+
+/**
+ * Get the cache file of the font (named after the hash of the font data).
+ */
+std::string AminoFont::getCachePath() {
+    char name[32];
+
+    snprintf(name, sizeof name, "%016llx.glyphs", (unsigned long long)fontHash);
+
+    return cacheDir + "/" + name;
+}
+
+/**
+ * Get a value changing whenever glyphs or kerning pairs were added.
+ *
+ * Note: glyphLock has to be locked.
+ */
+uint32_t AminoFont::getCacheState() {
+    uint32_t state = atlasPages.size();
+
+    for (auto const &page : atlasPages) {
+        state += page->atlas->version;
+    }
+
+    for (auto const &item : fontSizes) {
+        state += item.second->glyphs->size + item.second->kerning_map_count;
+    }
+
+    if (sdfFont) {
+        state += sdfFont->glyphs->size + sdfFont->kerning_map_count;
+    }
+
+    return state;
+}
+
+/**
+ * Restore the atlas pages and font sizes from the cache file.
+ *
+ * Note: called before the font is used by other threads.
+ */
+bool AminoFont::loadCache() {
+    std::string path = getCachePath();
+    bool res = false;
+
+#ifdef WIN
+    //read file
+    FILE *file = fopen(path.c_str(), "rb");
+
+    if (!file) {
+        return false;
+    }
+
+    std::vector<uint8_t> data;
+    uint8_t chunk[65536];
+    size_t count;
+
+    while ((count = fread(chunk, 1, sizeof chunk, file)) > 0) {
+        data.insert(data.end(), chunk, chunk + count);
+    }
+
+    fclose(file);
+
+    res = restoreCache(data.data(), data.size());
+#else
+    //memory-map file
+    int fd = open(path.c_str(), O_RDONLY);
+
+    if (fd == -1) {
+        return false;
+    }
+
+    struct stat info;
+
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        void *data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (data != MAP_FAILED) {
+            res = restoreCache((const uint8_t *)data, info.st_size);
+            munmap(data, info.st_size);
+        }
+    }
+
+    close(fd);
+#endif
+
+    if (DEBUG_FONTS) {
+        printf("-> glyph cache: %s (%s)\n", res ? "restored":"invalid", path.c_str());
+    }
+
+    return res;
+}
+
+/**
+ * Restore the glyphs of a cache file.
+ *
+ * Format: header, atlas pages (skyline nodes and bitmap), font sizes (glyph metrics and kerning pairs).
+ */
+bool AminoFont::restoreCache(const uint8_t *data, size_t len) {
+    const uint8_t *pos = data;
+    const uint8_t *end = data + len;
+
+    //header
+    char magic[4];
+    uint32_t version, pageSize, pageCount, sizeCount;
+    uint64_t hash;
+
+    if (!readCacheValue(pos, end, magic) || std::memcmp(magic, "AMGC", 4) != 0 ||
+        !readCacheValue(pos, end, version) || version != FONT_CACHE_VERSION ||
+        !readCacheValue(pos, end, hash) || hash != fontHash ||
+        !readCacheValue(pos, end, pageSize) || pageSize != ATLAS_PAGE_SIZE ||
+        !readCacheValue(pos, end, pageCount) || pageCount == 0 ||
+        !readCacheValue(pos, end, sizeCount)) {
+        return false;
+    }
+
+    //atlas pages
+    bool valid = true;
+
+    for (uint32_t i = 0; i < pageCount && valid; i++) {
+        uint32_t nodeCount, used;
+
+        if (!readCacheValue(pos, end, nodeCount) || nodeCount == 0 || nodeCount > pageSize || !readCacheValue(pos, end, used) ||
+            (size_t)(end - pos) < nodeCount * sizeof(ivec3) + pageSize * pageSize) {
+            valid = false;
+            break;
+        }
+
+        //skyline nodes have to be inside of the page
+        const ivec3 *nodes = (const ivec3 *)pos;
+
+        valid = used <= pageSize * pageSize;
+
+        for (uint32_t j = 0; j < nodeCount && valid; j++) {
+            const ivec3 &node = nodes[j];
+
+            valid = node.x >= 0 && node.y >= 0 && node.z >= 0 &&
+                    (int64_t)node.x + node.z <= (int64_t)pageSize && (uint32_t)node.y <= pageSize;
+        }
+
+        if (!valid) {
+            break;
+        }
+
+        amino_atlas_page_t *page = addAtlasPage();
+
+        if (!page) {
+            valid = false;
+            break;
+        }
+
+        pos += nodeCount * sizeof(ivec3);
+        texture_atlas_restore(page->atlas, nodes, nodeCount, used, pos);
+        pos += pageSize * pageSize;
+    }
+
+    //font sizes (glyphs are not rendered again)
+    texture_atlas_t *scratch = valid ? texture_atlas_new(16, 16, 1):NULL;
+
+    for (uint32_t i = 0; i < sizeCount && valid; i++) {
+        float size;
+        uint32_t rendermode, glyphCount, kerningCount;
+
+        if (!readCacheValue(pos, end, size) || size <= 0 || !readCacheValue(pos, end, rendermode) ||
+            !readCacheValue(pos, end, glyphCount) || !readCacheValue(pos, end, kerningCount)) {
+            valid = false;
+            break;
+        }
+
+        //Note: the null glyph is created on the scratch atlas and restored from the cache
+        texture_font_t *fontSize = scratch ? createFont(size, scratch):NULL;
+
+        if (!fontSize) {
+            valid = false;
+            break;
+        }
+
+        texture_font_remove_glyphs(fontSize, scratch);
+        fontSize->atlas = atlasPages.back()->atlas;
+        fontSize->rendermode = (rendermode_t)rendermode;
+
+        if (fontSize->rendermode == RENDER_SIGNED_DISTANCE_FIELD) {
+            if (sdfFont) {
+                texture_font_delete(sdfFont);
+            }
+
+            sdfFont = fontSize;
+        } else {
+            std::map<uint32_t, texture_font_t *>::iterator it = fontSizes.find((uint32_t)size);
+
+            if (it != fontSizes.end()) {
+                texture_font_delete(it->second);
+            }
+
+            fontSizes[(uint32_t)size] = fontSize;
+        }
+
+        //glyphs
+        for (uint32_t j = 0; j < glyphCount; j++) {
+            uint32_t codepoint, width, height, glyphRendermode, pageIndex;
+            int32_t offsetX, offsetY;
+            float advanceX, advanceY, s0, t0, s1, t1, outlineThickness;
+
+            if (!readCacheValue(pos, end, codepoint) || !readCacheValue(pos, end, width) || !readCacheValue(pos, end, height) ||
+                !readCacheValue(pos, end, offsetX) || !readCacheValue(pos, end, offsetY) ||
+                !readCacheValue(pos, end, advanceX) || !readCacheValue(pos, end, advanceY) ||
+                !readCacheValue(pos, end, s0) || !readCacheValue(pos, end, t0) || !readCacheValue(pos, end, s1) || !readCacheValue(pos, end, t1) ||
+                !readCacheValue(pos, end, glyphRendermode) || !readCacheValue(pos, end, outlineThickness) ||
+                !readCacheValue(pos, end, pageIndex) || pageIndex >= pageCount) {
+                valid = false;
+                break;
+            }
+
+            texture_glyph_t *glyph = texture_glyph_new();
+
+            if (!glyph) {
+                valid = false;
+                break;
+            }
+
+            glyph->codepoint = codepoint;
+            glyph->width = width;
+            glyph->height = height;
+            glyph->offset_x = offsetX;
+            glyph->offset_y = offsetY;
+            glyph->advance_x = advanceX;
+            glyph->advance_y = advanceY;
+            glyph->s0 = s0;
+            glyph->t0 = t0;
+            glyph->s1 = s1;
+            glyph->t1 = t1;
+            glyph->rendermode = (rendermode_t)glyphRendermode;
+            glyph->outline_thickness = outlineThickness;
+            glyph->atlas = atlasPages[pageIndex]->atlas;
+
+            texture_font_add_glyph(fontSize, glyph);
+        }
+
+        //kerning
+        for (uint32_t j = 0; j < kerningCount && valid; j++) {
+            uint32_t left, right;
+            float kerning;
+
+            if (!readCacheValue(pos, end, left) || !readCacheValue(pos, end, right) || !readCacheValue(pos, end, kerning)) {
+                valid = false;
+                break;
+            }
+
+            texture_font_set_kerning(fontSize, left, right, kerning);
+        }
+    }
+
+    if (scratch) {
+        texture_atlas_delete(scratch);
+    }
+
+    //start with empty atlas if invalid
+    if (!valid || pos != end) {
+        freeGlyphs();
+
+        return false;
+    }
+
+    cacheState = getCacheState();
+
+    return true;
+}
+
+/**
+ * Write the glyphs to the cache file if new glyphs were added.
+ *
+ * Note: has to be called in v8 thread.
+ */
+void AminoFont::saveCache() {
+    if (cacheDir.empty() || fontHash == 0) {
+        return;
+    }
+
+    std::vector<std::vector<uint8_t>> pageNodes;
+    std::vector<uint32_t> pageUsed;
+    std::vector<uint8_t> sizeData;
+    uint32_t sizeCount = 0;
+
+    //Note: only the metrics and the modified bitmap rows are copied while layout workers are blocked
+    {
+        std::lock_guard<std::mutex> lock(glyphLock);
+
+        uint32_t state = getCacheState();
+
+        if (atlasPages.empty() || state == cacheState) {
+            return;
+        }
+
+        cacheState = state;
+
+        //atlas pages
+        std::size_t pageCount = atlasPages.size();
+
+        cachePages.resize(pageCount);
+        cacheVersions.resize(pageCount, 0);
+
+        for (std::size_t i = 0; i < pageCount; i++) {
+            texture_atlas_t *atlas = atlasPages[i]->atlas;
+            uint8_t *nodes = (uint8_t *)atlas->nodes->items;
+            std::vector<uint8_t> &bitmap = cachePages[i];
+            size_t y = 0, height;
+
+            pageNodes.emplace_back(nodes, nodes + atlas->nodes->size * sizeof(ivec3));
+            pageUsed.push_back(atlas->used);
+
+            //modified rows since the last write
+            bitmap.resize(atlas->width * atlas->height);
+
+            while (texture_atlas_get_dirty_rows(atlas, cacheVersions[i], &y, &height)) {
+                std::memcpy(bitmap.data() + y * atlas->width, atlas->data + y * atlas->width, height * atlas->width);
+                y += height;
+            }
+
+            cacheVersions[i] = atlas->version;
+        }
+
+        //font sizes
+        std::vector<texture_font_t *> sizes;
+
+        for (auto const &item : fontSizes) {
+            sizes.push_back(item.second);
+        }
+
+        if (sdfFont) {
+            sizes.push_back(sdfFont);
+        }
+
+        sizeCount = sizes.size();
+
+        for (auto const &fontSize : sizes) {
+            appendCacheValue<float>(sizeData, fontSize->size);
+            appendCacheValue<uint32_t>(sizeData, fontSize->rendermode);
+            appendCacheValue<uint32_t>(sizeData, fontSize->glyphs->size);
+            appendCacheValue<uint32_t>(sizeData, fontSize->kerning_map_count);
+
+            //glyphs
+            for (size_t i = 0; i < fontSize->glyphs->size; i++) {
+                texture_glyph_t *glyph = *(texture_glyph_t **)vector_get(fontSize->glyphs, i);
+                uint32_t pageIndex = 0;
+
+                for (std::size_t j = 0; j < pageCount; j++) {
+                    if (atlasPages[j]->atlas == glyph->atlas) {
+                        pageIndex = j;
+                        break;
+                    }
+                }
+
+                appendCacheValue<uint32_t>(sizeData, glyph->codepoint);
+                appendCacheValue<uint32_t>(sizeData, glyph->width);
+                appendCacheValue<uint32_t>(sizeData, glyph->height);
+                appendCacheValue<int32_t>(sizeData, glyph->offset_x);
+                appendCacheValue<int32_t>(sizeData, glyph->offset_y);
+                appendCacheValue<float>(sizeData, glyph->advance_x);
+                appendCacheValue<float>(sizeData, glyph->advance_y);
+                appendCacheValue<float>(sizeData, glyph->s0);
+                appendCacheValue<float>(sizeData, glyph->t0);
+                appendCacheValue<float>(sizeData, glyph->s1);
+                appendCacheValue<float>(sizeData, glyph->t1);
+                appendCacheValue<uint32_t>(sizeData, glyph->rendermode);
+                appendCacheValue<float>(sizeData, glyph->outline_thickness);
+                appendCacheValue<uint32_t>(sizeData, pageIndex);
+            }
+
+            //kerning
+            for (size_t i = 0; i < fontSize->kerning_map_size; i++) {
+                kerning_t *kerning = &fontSize->kerning_map[i];
+
+                if (kerning->used) {
+                    appendCacheValue<uint32_t>(sizeData, kerning->left);
+                    appendCacheValue<uint32_t>(sizeData, kerning->right);
+                    appendCacheValue<float>(sizeData, kerning->kerning);
+                }
+            }
+        }
+    }
+
+    //header
+    std::vector<uint8_t> data;
+
+    data.insert(data.end(), { 'A', 'M', 'G', 'C' });
+    appendCacheValue<uint32_t>(data, FONT_CACHE_VERSION);
+    appendCacheValue<uint64_t>(data, fontHash);
+    appendCacheValue<uint32_t>(data, ATLAS_PAGE_SIZE);
+    appendCacheValue<uint32_t>(data, pageNodes.size());
+    appendCacheValue<uint32_t>(data, sizeCount);
+
+    //atlas pages
+    for (std::size_t i = 0; i < pageNodes.size(); i++) {
+        appendCacheValue<uint32_t>(data, pageNodes[i].size() / sizeof(ivec3));
+        appendCacheValue<uint32_t>(data, pageUsed[i]);
+        data.insert(data.end(), pageNodes[i].begin(), pageNodes[i].end());
+        data.insert(data.end(), cachePages[i].begin(), cachePages[i].end());
+    }
+
+    //font sizes
+    data.insert(data.end(), sizeData.begin(), sizeData.end());
+
+    //write (replaces the file when complete)
+    std::string path = getCachePath();
+    std::string tmpPath = path + ".tmp";
+    FILE *file = fopen(tmpPath.c_str(), "wb");
+
+    if (!file) {
+        if (DEBUG_FONTS) {
+            printf("-> could not write glyph cache: %s\n", tmpPath.c_str());
+        }
+
+        return;
+    }
+
+    bool written = fwrite(data.data(), 1, data.size(), file) == data.size();
+
+    written = fclose(file) == 0 && written;
+
+#ifdef WIN
+    remove(path.c_str());
+#endif
+
+    if (!written || rename(tmpPath.c_str(), path.c_str()) != 0) {
+        remove(tmpPath.c_str());
+
+        return;
+    }
+
+    if (DEBUG_FONTS) {
+        printf("-> glyph cache saved: %i bytes (%s)\n", (int)data.size(), path.c_str());
+    }
+}
+
+/**
+ * Write the glyph caches of all fonts (at most once per interval if not forced).
+ *
+ * Note: has to be called in v8 thread.
+ */
+void AminoFont::saveCaches(bool force) {
+    if (cacheDir.empty()) {
+        return;
+    }
+
+    double now = getTime();
+
+    if (!force && now - cacheSaveTime < FONT_CACHE_SAVE_INTERVAL) {
+        return;
+    }
+
+    cacheSaveTime = now;
+
+    for (auto const &font : instances) {
+        font->saveCache();
+    }
+}
+
+FT_Library AminoFont::library = NULL;
+std::vector<AminoFont *> AminoFont::instances;
+std::atomic<uint32_t> AminoFont::frame { 0 };
+uint32_t AminoFont::maxAtlasPages = ATLAS_MAX_PAGES;
+uint32_t AminoFont::atlasEvictFrames = ATLAS_EVICT_FRAMES;
+std::atomic<uint32_t> AminoFont::atlasEvictions { 0 };
+std::string AminoFont::cacheDir;
+double AminoFont::cacheSaveTime = 0;
+
+//
+//  AminoFontFactory
+//
+
+/**
+ * Create AminoFont factory.
+ */
+AminoFontFactory::AminoFontFactory(Nan::FunctionCallback callback): AminoJSObjectFactory("AminoFont", callback) {
+    //empty
+}
+
+/**
+ * Create AminoFonts instance.
+ */
+AminoJSObject* AminoFontFactory::create() {
+    return new AminoFont();
+}
+
+//
+// AsyncGlyphWorker
+//
+
+/**
+ * Asynchronous glyph loader.
+ */
+class AsyncGlyphWorker : public Nan::AsyncWorker {
+private:
+    AminoFontSize *fontSize;
+    std::string codepoints;
+
+    //result
+    std::vector<texture_atlas_t *> atlases;
+    uint32_t missing = 0;
+
+public:
+    AsyncGlyphWorker(Nan::Callback *callback, v8::Local<v8::Object> &obj, AminoFontSize *fontSize, std::string codepoints) : AsyncWorker(callback) {
+        SaveToPersistent("object", obj);
+
+        this->fontSize = fontSize;
+        this->codepoints = codepoints;
+    }
+
+    /**
+     * Async running code.
+     */
+    void Execute() {
+        TRACE_SCOPE("preloadGlyphs");
+
+        missing = fontSize->font->loadGlyphs(fontSize->fontTexture, codepoints.data(), codepoints.size(), atlases);
+
+        if (DEBUG_FONTS) {
+            printf("-> preloaded glyphs: %i atlases, %i missing\n", (int)atlases.size(), (int)missing);
+        }
+    }
+
+    /**
+     * Upload the atlases to all instances.
+     */
+    void HandleOKCallback() {
+        amino_glyph_preload_t *preload = new amino_glyph_preload_t();
+
+        //Note: callback owned by preload
+        preload->callback = callback;
+        preload->atlases = atlases;
+        preload->missing = missing;
+        preload->pending = 0;
+
+        callback = NULL;
+
+        AminoGfx::preloadAtlasTextures(preload);
+    }
+};
+
+//
+// AminoFontSize
+//
+
+AminoFontSize::AminoFontSize(): AminoJSObject(getFactory()->name) {
+    //empty
+}
+
+AminoFontSize::~AminoFontSize() {
+    //empty
+}
+
+/**
+ * Get factory instance.
+ */
+AminoFontSizeFactory* AminoFontSize::getFactory() {
+    static AminoFontSizeFactory *aminoFontSizeFactory = NULL;
+
+    if (!aminoFontSizeFactory) {
+        aminoFontSizeFactory = new AminoFontSizeFactory(New);
+    }
+
+    return aminoFontSizeFactory;
+}
+
+/**
+ * Initialize AminoFontSize template.
+ */
+v8::Local<v8::FunctionTemplate> AminoFontSize::GetInitFunction() {
+    v8::Local<v8::FunctionTemplate> tpl = AminoJSObject::createTemplate(getFactory());
+
+    //methods
+    Nan::SetPrototypeMethod(tpl, "_calcTextWidth", CalcTextWidth);
+    Nan::SetPrototypeMethod(tpl, "_calcTextWidths", CalcTextWidths);
+    Nan::SetPrototypeMethod(tpl, "_preloadGlyphs", PreloadGlyphs);
+    Nan::SetPrototypeMethod(tpl, "getFontMetrics", GetFontMetrics);
+
+    //template function
+    return tpl;
+}
+
+/**
+ * JS object construction.
+ */
+NAN_METHOD(AminoFontSize::New) {
+    AminoJSObject::createInstance(info, getFactory());
+}
+
+/**
+ * Initialize constructor values.
+ */
+void AminoFontSize::preInit(Nan::NAN_METHOD_ARGS_TYPE info) {
+    assert(info.Length() == 2 || info.Length() == 3);
+
+    AminoFont *font = Nan::ObjectWrap::Unwrap<AminoFont>(Nan::To<v8::Object>(info[0]).ToLocalChecked());
+    double size = Nan::To<v8::Number>(info[1]).ToLocalChecked()->Value();
+
+    assert(font);
+
+    this->font = font;
+
+    if (info.Length() == 3) {
+        sdf = Nan::To<bool>(info[2]).FromJust();
+    }
+
+    if (sdf) {
+        //scaled glyphs (any size)
+        fontTexture = font->getSdfFont();
+        scale = size / SDF_FONT_SIZE;
+    } else {
+        fontTexture = font->getFontWithSize((uint32_t)size);
+    }
+
+    if (!fontTexture) {
+        Nan::ThrowTypeError("could not create font size");
+    }
+
+    //font properties
+    v8::Local<v8::Object> obj = handle();
+
+    Nan::Set(obj, Nan::New("name").ToLocalChecked(), Nan::New<v8::String>(font->fontName).ToLocalChecked());
+    Nan::Set(obj, Nan::New("size").ToLocalChecked(), Nan::New<v8::Number>(size));
+    Nan::Set(obj, Nan::New("weight").ToLocalChecked(), Nan::New<v8::Number>(font->fontWeight));
+    Nan::Set(obj, Nan::New("style").ToLocalChecked(), Nan::New<v8::String>(font->fontStyle).ToLocalChecked());
+    Nan::Set(obj, Nan::New("sdf").ToLocalChecked(), Nan::New<v8::Boolean>(sdf));
+}
+
+/**
+ * Calculate text width.
+ */
+NAN_METHOD(AminoFontSize::CalcTextWidth) {
+    assert(info.Length() == 1);
+
+    AminoFontSize *obj = Nan::ObjectWrap::Unwrap<AminoFontSize>(info.This());
+    Nan::Utf8String str(info[0]);
+
+    assert(obj);
+
+    info.GetReturnValue().Set(obj->getTextWidth(*str));
+}
+
+/**
+ * Calculate the widths of multiple texts (one native call).
+ *
+ * Returns a Float32Array of widths. If a wrap width is passed, the texts are word wrapped and an object is returned:
+ *
+ *  - widths: Float32Array (widest line)
+ *  - lines: Uint32Array (line count)
+ *  - breaks: Uint32Array (character offset of each new line; lines - 1 entries per text)
+ */
+NAN_METHOD(AminoFontSize::CalcTextWidths) {
+    AminoFontSize *obj = Nan::ObjectWrap::Unwrap<AminoFontSize>(info.This());
+
+    assert(obj);
+
+    if (info.Length() < 1 || !info[0]->IsArray()) {
+        Nan::ThrowTypeError("array of texts expected");
+        return;
+    }
+
+    v8::Local<v8::Array> texts = v8::Local<v8::Array>::Cast(info[0]);
+    uint32_t count = texts->Length();
+    float wrapWidth = 0;
+
+    if (info.Length() > 1 && info[1]->IsNumber()) {
+        wrapWidth = Nan::To<v8::Number>(info[1]).ToLocalChecked()->Value();
+    }
+
+    bool wrap = wrapWidth > 0;
+
+    //result
+    v8::Local<v8::Float32Array> widths = v8::Float32Array::New(v8::ArrayBuffer::New(v8::Isolate::GetCurrent(), count * sizeof(float)), 0, count);
+    v8::Local<v8::Uint32Array> lines;
+    float *widthData = (float *)widths->Buffer()->GetContents().Data();
+    uint32_t *lineData = NULL;
+    std::vector<uint32_t> breaks;
+    std::vector<texture_atlas_t *> atlases;
+
+    if (wrap) {
+        lines = v8::Uint32Array::New(v8::ArrayBuffer::New(v8::Isolate::GetCurrent(), count * sizeof(uint32_t)), 0, count);
+        lineData = (uint32_t *)lines->Buffer()->GetContents().Data();
+    }
+
+    //Note: strings are converted first (no JS calls while the font is locked)
+    std::vector<std::string> strs(count);
+
+    for (uint32_t i = 0; i < count; i++) {
+        Nan::Utf8String str(Nan::Get(texts, i).ToLocalChecked());
+
+        if (*str) {
+            strs[i] = *str;
+        }
+    }
+
+    obj->font->glyphLock.lock();
+
+    for (uint32_t i = 0; i < count; i++) {
+        widthData[i] = obj->measureText(strs[i].c_str(), wrapWidth, wrap ? &lineData[i]:NULL, wrap ? &breaks:NULL, atlases);
+    }
+
+    obj->font->glyphLock.unlock();
+
+    //update all instances (once)
+    for (auto const &atlas : atlases) {
+        AminoGfx::updateAtlasTextures(atlas);
+    }
+
+    if (!wrap) {
+        info.GetReturnValue().Set(widths);
+        return;
+    }
+
+    std::size_t breakCount = breaks.size();
+    v8::Local<v8::Uint32Array> breaksArr = v8::Uint32Array::New(v8::ArrayBuffer::New(v8::Isolate::GetCurrent(), breakCount * sizeof(uint32_t)), 0, breakCount);
+
+    if (breakCount > 0) {
+        std::memcpy(breaksArr->Buffer()->GetContents().Data(), breaks.data(), breakCount * sizeof(uint32_t));
+    }
+
+    v8::Local<v8::Object> res = Nan::New<v8::Object>();
+
+    Nan::Set(res, Nan::New("widths").ToLocalChecked(), widths);
+    Nan::Set(res, Nan::New("lines").ToLocalChecked(), lines);
+    Nan::Set(res, Nan::New("breaks").ToLocalChecked(), breaksArr);
+
+    info.GetReturnValue().Set(res);
+}
+
+/**
+ * Load glyphs on a worker thread.
+ *
+ * The callback is called once the atlas textures of all instances were updated: (err, missing).
+ */
+NAN_METHOD(AminoFontSize::PreloadGlyphs) {
+    if (info.Length() < 2 || !info[1]->IsFunction()) {
+        Nan::ThrowTypeError("missing callback");
+        return;
+    }
+
+    AminoFontSize *obj = Nan::ObjectWrap::Unwrap<AminoFontSize>(info.This());
+    v8::Local<v8::Object> objHandle = info.This();
+    Nan::Utf8String str(info[0]);
+    Nan::Callback *callback = new Nan::Callback(info[1].As<v8::Function>());
+
+    assert(obj);
+
+    AsyncQueueWorker(new AsyncGlyphWorker(callback, objHandle, obj, *str ? std::string(*str, str.length()):""));
+}
+
+/**
+ * An instance has updated its atlas textures.
+ *
+ * Note: called on main thread.
+ */
+void AminoFontSize::preloadDone(amino_glyph_preload_t *preload) {
+    assert(preload->pending > 0);
+
+    preload->pending--;
+
+    if (preload->pending > 0) {
+        return;
+    }
+
+    //create scope
+    Nan::HandleScope scope;
+
+    //call
+    v8::Local<v8::Value> argv[] = { Nan::Null(), Nan::New(preload->missing) };
+
+    Nan::Call(*preload->callback, 2, argv);
+
+    delete preload->callback;
+    delete preload;
+}
+
+/**
+ * Calculate text width.
+ */
+float AminoFontSize::getTextWidth(const char *text) {
+    std::vector<texture_atlas_t *> atlases;
+
+    font->glyphLock.lock();
+
+    float w = measureText(text, 0, NULL, NULL, atlases);
+
+    font->glyphLock.unlock();
+
+    //update all instances
+    for (auto const &atlas : atlases) {
+        AminoGfx::updateAtlasTextures(atlas);
+    }
+
+    return w;
+}
+
+/**
+ * Measure a text.
+ *
+ * Without wrap width the advances of all characters are added. Otherwise the text is word wrapped, the widest line is returned
+ * and the character offsets of the new lines are appended to breaks.
+ *
+ * Modified atlases are added to atlases.
+ *
+ * Note: glyphLock has to be locked.
+ */
+float AminoFontSize::measureText(const char *text, float wrapWidth, uint32_t *lines, std::vector<uint32_t> *breaks, std::vector<texture_atlas_t *> &atlases) {
+    size_t len = utf8_strlen(text);
+    char *textPos = (char *)text;
+    char *lastTextPos = NULL;
+    float w = 0;
+    bool wrap = wrapWidth > 0;
+
+    //wrapping
+    float maxW = 0;
+    uint32_t lineCount = 1;
+    size_t lineStart = 0;
+    size_t wordStart = 0; //after last white space of line
+    float wordX = 0; //pen position at word start
+    float lineW = 0; //line width up to last white space
+
+    texture_atlas_t *lastAtlas = fontTexture->atlas;
+    uint32_t lastVersion = lastAtlas->version;
+
+    for (std::size_t i = 0; i < len; i++) {
+        texture_glyph_t *glyph = texture_font_get_glyph(fontTexture, textPos);
+        size_t charLen = utf8_surrogate_len(textPos);
+
+        if (!glyph) {
+            printf("Error: got empty glyph from texture_font_get_glyph()\n");
+
+            textPos += charLen;
+            continue;
+        }
+
+        //kerning
+        float kerning = 0;
+
+        if (lastTextPos) {
+            kerning = texture_font_get_kerning(fontTexture, glyph, lastTextPos) * scale;
+        }
+
+        if (wrap) {
+            bool space = std::iswspace((wchar_t)glyph->codepoint);
+
+            if (glyph->codepoint == '\n') {
+                //new line
+                maxW = std::max(maxW, w);
+                w = 0;
+                lineCount++;
+                lineStart = wordStart = i + 1;
+                lastTextPos = NULL;
+
+                if (breaks) {
+                    breaks->push_back(i + 1);
+                }
+
+                textPos += charLen;
+                continue;
+            }
+
+            if (!space && i > lineStart && w + kerning + (glyph->offset_x + glyph->width) * scale > wrapWidth) {
+                lineCount++;
+
+                if (wordStart > lineStart) {
+                    //wrap word
+                    maxW = std::max(maxW, lineW);
+                    w -= wordX;
+                    lineStart = wordStart;
+                } else {
+                    //wrap character
+                    maxW = std::max(maxW, w);
+                    w = 0;
+                    kerning = 0;
+                    lineStart = wordStart = i;
+                }
+
+                if (breaks) {
+                    breaks->push_back(lineStart);
+                }
+            }
+
+            w += kerning + glyph->advance_x * scale;
+
+            if (space) {
+                wordStart = i + 1;
+                wordX = w;
+                lineW = w - glyph->advance_x * scale;
+            }
+        } else {
+            //char width
+            w += kerning + glyph->advance_x * scale;
+        }
+
+        //next
+        lastTextPos = textPos;
+        textPos += charLen;
+    }
+
+    //Note: new glyphs are stored in the current atlas page
+    texture_atlas_t *atlas = fontTexture->atlas;
+
+    if (atlas != lastAtlas || atlas->version != lastVersion) {
+        if (std::find(atlases.begin(), atlases.end(), atlas) == atlases.end()) {
+            atlases.push_back(atlas);
+        }
+
+        if (atlas != lastAtlas && std::find(atlases.begin(), atlases.end(), lastAtlas) == atlases.end()) {
+            atlases.push_back(lastAtlas);
+        }
+    }
+
+    if (lines) {
+        *lines = lineCount;
+    }
+
+    return wrap ? std::max(maxW, w):w;
+}
+
+/**
+ * Get font metrics (height, ascender, descender).
+ */
+NAN_METHOD(AminoFontSize::GetFontMetrics) {
+    AminoFontSize *obj = Nan::ObjectWrap::Unwrap<AminoFontSize>(info.This());
+
+    assert(obj);
+
+    //metrics
+    v8::Local<v8::Object> metricsObj = Nan::New<v8::Object>();
+
+    float scale = obj->scale;
+
+    Nan::Set(metricsObj, Nan::New("height").ToLocalChecked(), Nan::New<v8::Number>((obj->fontTexture->ascender - obj->fontTexture->descender) * scale));
+    Nan::Set(metricsObj, Nan::New("ascender").ToLocalChecked(), Nan::New<v8::Number>(obj->fontTexture->ascender * scale));
+    Nan::Set(metricsObj, Nan::New("descender").ToLocalChecked(), Nan::New<v8::Number>(obj->fontTexture->descender * scale));
+
+    info.GetReturnValue().Set(metricsObj);
+}
+
+//
+//  AminoFontSizeFactory
+//
+
+/**
+ * Create AminoFontSize factory.
+ */
+AminoFontSizeFactory::AminoFontSizeFactory(Nan::FunctionCallback callback): AminoJSObjectFactory("AminoFontSize", callback) {
+    //empty
+}
+
+/**
+ * Create AminoFonts instance.
+ */
+AminoJSObject* AminoFontSizeFactory::create() {
+    return new AminoFontSize();
+}
+
+//
+// AminoFontShader
+//
+
+AminoFontShader::AminoFontShader() : TextureShader() {
+    //shader
+
+    //Note: using unmodified vertex shader
+    fragmentShader = R"(
+        #ifdef GL_ES
+            precision mediump float;
+        #endif
+
+        uniform float opacity;
+        uniform vec3 color;
+        uniform sampler2D tex;
+
+        varying vec2 uv;
+
+        void main() {
+            float a = texture2D(tex, uv).a;
+
+            gl_FragColor = vec4(color, opacity * a);
+        }
+    )";
+}
+
+/**
+ * Initialize the font shader.
+ */
+void AminoFontShader::initShader() {
+    TextureShader::initShader();
+
+    //uniforms
+    uColor = getUniformLocation("color");
+}
+
+/**
+ * Set color.
+ */
+void AminoFontShader::setColor(GLfloat color[3]) {
+    glUniform3f(uColor, color[0], color[1], color[2]);
+}
+
+/**
+ * Get texture for atlas.
+ *
+ * Note: has to be called on OpenGL thread.
+ */
+amino_atlas_t AminoFontShader::getAtlasTexture(texture_atlas_t *atlas, bool createIfMissing, bool &newTexture) {
+    std::map<texture_atlas_t *, amino_atlas_t>::iterator it = atlasTextures.find(atlas);
+
+    newTexture = false;
 
     if (it == atlasTextures.end()) {
         if (!createIfMissing) {
@@ -522,6 +1688,7 @@ amino_atlas_t AminoFontShader::getAtlasTexture(texture_atlas_t *atlas, bool crea
         amino_atlas_t item;
 
         item.textureId = id;
+        item.version = 0;
 
         atlasTextures[atlas] = item;
 
@@ -533,3 +1700,127 @@ amino_atlas_t AminoFontShader::getAtlasTexture(texture_atlas_t *atlas, bool crea
 
     return it->second;
 }
+
+/**
+ * Upload the modified rows of an atlas to its texture.
+ *
+ * Note: has to be called on OpenGL thread.
+ */
+void AminoFontShader::uploadAtlasTexture(texture_atlas_t *atlas) {
+    std::map<texture_atlas_t *, amino_atlas_t>::iterator it = atlasTextures.find(atlas);
+
+    if (it == atlasTextures.end()) {
+        return;
+    }
+
+    //glyphs might be added by layout workers
+    amino_atlas_page_t *page = static_cast<amino_atlas_page_t *>(atlas->user_data);
+
+    assert(page);
+
+    std::lock_guard<std::mutex> lock(page->font->glyphLock);
+
+    AminoText::updateTextureFromAtlas(it->second.textureId, atlas, it->second.version);
+}
+
+//
+// AminoFontSdfShader
+//
+
+AminoFontSdfShader::AminoFontSdfShader() : AminoFontShader() {
+    //shader
+
+    //Note: using unmodified vertex shader
+    //Note: distance 0.5 is the glyph outline, smoothing covers about one pixel
+    fragmentShader = R"(
+        #ifdef GL_ES
+            precision mediump float;
+        #endif
+
+        uniform float opacity;
+        uniform vec3 color;
+        uniform sampler2D tex;
+
+        uniform float smoothing;
+        uniform float outlineWidth;
+        uniform vec3 outlineColor;
+        uniform vec2 shadowOffset;
+        uniform float shadowSoftness;
+        uniform vec4 shadowColor;
+
+        varying vec2 uv;
+
+        void main() {
+            float dist = texture2D(tex, uv).a;
+            float alpha = smoothstep(0.5 - smoothing, 0.5 + smoothing, dist);
+            vec4 fg = vec4(color, alpha);
+
+            //outline
+            if (outlineWidth > 0.) {
+                float edge = 0.5 - outlineWidth;
+
+                fg = vec4(mix(outlineColor, color, alpha), smoothstep(edge - smoothing, edge + smoothing, dist));
+            }
+
+            //shadow (behind glyph)
+            if (shadowColor.a > 0.) {
+                float shadowDist = texture2D(tex, uv - shadowOffset).a;
+                float shadowAlpha = shadowColor.a * smoothstep(0.5 - shadowSoftness - smoothing, 0.5 + shadowSoftness + smoothing, shadowDist);
+                float a = fg.a + shadowAlpha * (1. - fg.a);
+
+                if (a > 0.) {
+                    fg = vec4((fg.rgb * fg.a + shadowColor.rgb * shadowAlpha * (1. - fg.a)) / a, a);
+                }
+            }
+
+            gl_FragColor = vec4(fg.rgb, opacity * fg.a);
+        }
+    )";
+}
+
+/**
+ * Initialize the SDF font shader.
+ */
+void AminoFontSdfShader::initShader() {
+    AminoFontShader::initShader();
+
+    //uniforms
+    uSmoothing = getUniformLocation("smoothing");
+    uOutlineWidth = getUniformLocation("outlineWidth");
+    uOutlineColor = getUniformLocation("outlineColor");
+    uShadowOffset = getUniformLocation("shadowOffset");
+    uShadowSoftness = getUniformLocation("shadowSoftness");
+    uShadowColor = getUniformLocation("shadowColor");
+}
+
+/**
+ * Set edge smoothing (distance).
+ */
+void AminoFontSdfShader::setSmoothing(GLfloat smoothing) {
+    glUniform1f(uSmoothing, smoothing);
+}
+
+/**
+ * Set outline (width as distance, 0 to disable).
+ */
+void AminoFontSdfShader::setOutline(GLfloat width, GLfloat color[3]) {
+    glUniform1f(uOutlineWidth, width);
+    glUniform3f(uOutlineColor, color[0], color[1], color[2]);
+}
+
+/**
+ * Set shadow (offset in texture coordinates, softness as distance, alpha 0 to disable).
+ */
+void AminoFontSdfShader::setShadow(GLfloat offset[2], GLfloat softness, GLfloat color[4]) {
+    glUniform2f(uShadowOffset, offset[0], offset[1]);
+    glUniform1f(uShadowSoftness, softness);
+    glUniform4f(uShadowColor, color[0], color[1], color[2], color[3]);
+}
+
+/**
+ * Set interleaved position and texture coordinates.
+ */
+void AminoFontSdfShader::setGlyphVertexData(GLsizei stride, GLfloat *pos, GLfloat *uv) {
+    glVertexAttribPointer(aPos, 3, GL_FLOAT, GL_FALSE, stride, pos);
+    glVertexAttribPointer(aTexCoord, 2, GL_FLOAT, GL_FALSE, stride, uv);
+}
@@ -5,6 +5,9 @@
 #include "vertex-buffer.h"
 
 #include <map>
+#include <vector>
+#include <atomic>
+#include <mutex>
 
 #include "base_js.h"
 #include "gfx.h"
@@ -41,8 +44,19 @@ public:
     AminoJSObject* create() override;
 };
 
+class AminoFont;
 class AminoFontFactory;
 
+/**
+ * Atlas page of a font (shared by all font sizes).
+ */
+struct amino_atlas_page_t {
+    AminoFont *font;
+    texture_atlas_t *atlas;
+    std::atomic<uint32_t> lastUsed { 0 }; //frame
+    std::atomic<uint32_t> evictions { 0 };
+};
+
 /**
  * AminoFont class.
  */
@@ -52,12 +66,32 @@ public:
     int fontWeight;
     std::string fontStyle;
 
+    //guards glyph loading and the atlas pages (per font)
+    std::mutex glyphLock;
+
     AminoFont();
     ~AminoFont();
 
     texture_font_t *getFontWithSize(uint32_t size);
+    texture_font_t *getSdfFont();
     std::string getFontInfo();
 
+    //atlas pages
+    amino_atlas_page_t *getAtlasPage(texture_atlas_t *atlas);
+    static void nextFrame();
+    static uint32_t getFrame();
+    static uint32_t getAtlasEvictions();
+    static void setMaxAtlasPages(uint32_t pages);
+    static void setAtlasEvictFrames(uint32_t frames);
+    static void getAtlasStats(v8::Local<v8::Object> &obj);
+
+    //preloading
+    uint32_t loadGlyphs(texture_font_t *fontSize, const char *codepoints, std::size_t length, std::vector<texture_atlas_t *> &atlases);
+
+    //glyph cache
+    static void setCacheDir(std::string dir);
+    static void saveCaches(bool force);
+
     //creation
     static AminoFontFactory* getFactory();
 
@@ -68,6 +102,17 @@ private:
     //Note: instance kept
     static FT_Library library;
 
+    //atlas pages
+    static std::vector<AminoFont *> instances;
+    static std::atomic<uint32_t> frame;
+    static uint32_t maxAtlasPages;
+    static uint32_t atlasEvictFrames;
+    static std::atomic<uint32_t> atlasEvictions;
+
+    //glyph cache
+    static std::string cacheDir;
+    static double cacheSaveTime;
+
     //JS constructor
     static NAN_METHOD(New);
 
@@ -75,9 +120,29 @@ private:
 
 protected:
     AminoFonts *fonts = NULL;
-    texture_atlas_t *atlas = NULL;
+    std::vector<amino_atlas_page_t *> atlasPages;
     Nan::Persistent<v8::Object> fontData;
     std::map<uint32_t, texture_font_t *> fontSizes;
+    texture_font_t *sdfFont = NULL; //shared by all SDF font sizes
+
+    //glyph cache
+    uint64_t fontHash = 0;
+    uint32_t cacheState = 0; //glyph state of the cache file
+    std::vector<std::vector<uint8_t>> cachePages; //page bitmaps of the cache file (v8 thread)
+    std::vector<uint32_t> cacheVersions; //atlas versions of cachePages
+
+    texture_font_t *createFont(float size, texture_atlas_t *atlas = NULL);
+    void freeGlyphs();
+    amino_atlas_page_t *addAtlasPage();
+    texture_atlas_t *nextAtlasPage(texture_font_t *fontSize);
+    void evictAtlasPage(amino_atlas_page_t *page);
+    static texture_atlas_t *atlasFull(texture_font_t *fontSize, void *data);
+
+    std::string getCachePath();
+    uint32_t getCacheState();
+    bool loadCache();
+    bool restoreCache(const uint8_t *data, size_t len);
+    void saveCache();
 
     void destroy() override;
     void destroyAminoFont();
@@ -95,6 +160,16 @@ public:
 
 class AminoFontSizeFactory;
 
+/**
+ * Glyph preloading waiting for the atlas textures (main thread).
+ */
+struct amino_glyph_preload_t {
+    Nan::Callback *callback;
+    std::vector<texture_atlas_t *> atlases; //modified atlases
+    uint32_t missing; //glyphs not stored (atlas full)
+    uint32_t pending; //instances uploading the atlases
+};
+
 /**
  * AminoFontSize class.
  */
@@ -103,10 +178,18 @@ public:
     texture_font_t *fontTexture = NULL;
     AminoFont *font = NULL;
 
+    //signed distance field (glyphs scaled from shared font)
+    bool sdf = false;
+    float scale = 1;
+
     AminoFontSize();
     ~AminoFontSize();
 
     float getTextWidth(const char *text);
+    float measureText(const char *text, float wrapWidth, uint32_t *lines, std::vector<uint32_t> *breaks, std::vector<texture_atlas_t *> &atlases);
+
+    //preloading
+    static void preloadDone(amino_glyph_preload_t *preload);
 
     //creation
     static AminoFontSizeFactory* getFactory();
@@ -120,6 +203,8 @@ private:
 
     //JS methods
     static NAN_METHOD(CalcTextWidth);
+    static NAN_METHOD(CalcTextWidths);
+    static NAN_METHOD(PreloadGlyphs);
     static NAN_METHOD(GetFontMetrics);
 
     void preInit(Nan::NAN_METHOD_ARGS_TYPE info) override;
@@ -140,6 +225,16 @@ public:
  */
 struct amino_atlas_t {
     GLuint textureId;
+    uint32_t version; //uploaded atlas version (0 if empty)
+};
+
+/**
+ * Atlas page used by a text.
+ */
+struct amino_text_page_t {
+    amino_atlas_page_t *page;
+    GLuint textureId;
+    uint32_t evictions; //page evictions at layout time
 };
 
 /**
@@ -152,6 +247,7 @@ public:
     void setColor(GLfloat color[3]);
 
     amino_atlas_t getAtlasTexture(texture_atlas_t *atlas, bool createIfMissing, bool &newTexture);
+    void uploadAtlasTexture(texture_atlas_t *atlas);
 
 protected:
     GLint uColor;
@@ -162,4 +258,26 @@ protected:
     void initShader() override;
 };
 
+/**
+ * Signed distance field font shader (optional outline and shadow).
+ */
+class AminoFontSdfShader : public AminoFontShader {
+public:
+    AminoFontSdfShader();
+
+    void setSmoothing(GLfloat smoothing);
+    void setOutline(GLfloat width, GLfloat color[3]);
+    void setShadow(GLfloat offset[2], GLfloat softness, GLfloat color[4]);
+
+    //per vertex data (interleaved)
+    void setGlyphVertexData(GLsizei stride, GLfloat *pos, GLfloat *uv);
+
+protected:
+    GLint uSmoothing;
+    GLint uOutlineWidth, uOutlineColor;
+    GLint uShadowOffset, uShadowSoftness, uShadowColor;
+
+    void initShader() override;
+};
+
 #endif
\ No newline at end of file
@@ -38,8 +38,9 @@
 #include "edtaa3func.h"
 
 
-double *
-make_distance_mapd( double *data, unsigned int width, unsigned int height )
+/* Signed distance in pixels (outside positive), returned in outside */
+static double *
+compute_distance_map( double *data, unsigned int width, unsigned int height )
 {
     short * xdist = (short *)  malloc( width * height * sizeof(short) );
     short * ydist = (short *)  malloc( width * height * sizeof(short) );
@@ -47,7 +48,6 @@ make_distance_mapd( double *data, unsigned int width, unsigned int height )
     double * gy      = (double *) calloc( width * height, sizeof(double) );
     double * outside = (double *) calloc( width * height, sizeof(double) );
     double * inside  = (double *) calloc( width * height, sizeof(double) );
-    double vmin = DBL_MAX;
     unsigned int i;
 
     //@appamics.CB: extra checks
@@ -78,8 +78,25 @@ make_distance_mapd( double *data, unsigned int width, unsigned int height )
 
     // distmap = outside - inside; % Bipolar distance field
     for( i=0; i<width*height; ++i)
-    {
         outside[i] -= inside[i];
+
+    free( xdist );
+    free( ydist );
+    free( gx );
+    free( gy );
+    free( inside );
+    return outside;
+}
+
+double *
+make_distance_mapd( double *data, unsigned int width, unsigned int height )
+{
+    double * outside = compute_distance_map( data, width, height );
+    double vmin = DBL_MAX;
+    unsigned int i;
+
+    for( i=0; i<width*height; ++i)
+    {
         if( outside[i] < vmin )
             vmin = outside[i];
     }
@@ -94,12 +111,7 @@ make_distance_mapd( double *data, unsigned int width, unsigned int height )
         data[i] = (outside[i]+vmin)/(2*vmin);
     }
 
-    free( xdist );
-    free( ydist );
-    free( gx );
-    free( gy );
     free( outside );
-    free( inside );
     return data;
 }
 
@@ -143,3 +155,39 @@ make_distance_mapb( unsigned char *img,
 
     return out;
 }
+
+unsigned char *
+make_distance_mapb_spread( unsigned char *img,
+                           unsigned int width, unsigned int height,
+                           double spread )
+{
+    double * data    = (double *) calloc( width * height, sizeof(double) );
+    unsigned char *out = (unsigned char *) malloc( width * height * sizeof(unsigned char) );
+    double * dist;
+    unsigned int i;
+
+    //@appamics.CB: extra checks
+    assert(data);
+    assert(out);
+    assert(spread > 0);
+
+    // Map values from 0 - 255 to 0.0 - 1.0
+    for( i=0; i<width*height; ++i)
+        data[i] = img[i] / 255.0;
+
+    dist = compute_distance_map(data, width, height);
+
+    // map distance -spread .. +spread to 255 - 0 (edge at 128)
+    for( i=0; i<width*height; ++i)
+    {
+        double v = 0.5 - dist[i] / (2 * spread);
+        if     ( v < 0.0 ) v = 0.0;
+        else if( v > 1.0 ) v = 1.0;
+        out[i] = (unsigned char)(255 * v + 0.5);
+    }
+
+    free( dist );
+    free( data );
+
+    return out;
+}
@@ -87,6 +87,25 @@ make_distance_mapb( unsigned char *img,
 
 /** @} */
 
+/**
+ * Create a distance field with a fixed spread (the same distance maps to the
+ * same value in all fields).
+ *
+ * Addition to Freetype GL.
+ *
+ * @param img     A greyscale image.
+ * @param width   The width of the given image.
+ * @param height  The height of the given image.
+ * @param spread  Distance (pixels) mapped to 0 (outside) and 255 (inside).
+ *
+ * @return        A newly allocated distance field.  This image must
+ *                be freed after usage.
+ */
+unsigned char *
+make_distance_mapb_spread( unsigned char *img,
+                           unsigned int width, unsigned int height,
+                           double spread );
+
 #ifdef __cplusplus
 }
 }
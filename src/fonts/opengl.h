@@ -54,4 +54,8 @@
 #include <GLES2/gl2.h>
 #endif
 
+#ifdef HEADLESS
+#include <GLES2/gl2.h>
+#endif
+
 #endif
\ No newline at end of file
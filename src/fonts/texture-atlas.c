@@ -45,6 +45,7 @@ texture_atlas_new( const size_t width,
                    const size_t height,
                    const size_t depth )
 {
+    size_t i;
     texture_atlas_t *self = (texture_atlas_t *) malloc( sizeof(texture_atlas_t) );
 
     // We want a one pixel border around the whole atlas to avoid any artefact when
@@ -64,6 +65,8 @@ texture_atlas_new( const size_t width,
     self->height = height;
     self->depth = depth;
     self->id = 0;
+    self->version = 1;
+    self->user_data = NULL;
 
     vector_push_back( self->nodes, &node );
     self->data = (unsigned char *)
@@ -76,6 +79,21 @@ texture_atlas_new( const size_t width,
         exit( EXIT_FAILURE );
     }
 
+    /* All rows are new */
+    self->row_versions = (uint32_t *) malloc( height * sizeof(uint32_t) );
+
+    if( self->row_versions == NULL)
+    {
+        fprintf( stderr,
+                 "line %d: No more memory for allocating data\n", __LINE__ );
+        exit( EXIT_FAILURE );
+    }
+
+    for( i = 0; i < height; ++i )
+    {
+        self->row_versions[i] = self->version;
+    }
+
     return self;
 }
 
@@ -90,6 +108,7 @@ texture_atlas_delete( texture_atlas_t *self )
     {
         free( self->data );
     }
+    free( self->row_versions );
     free( self );
 }
 
@@ -118,14 +137,52 @@ texture_atlas_set_region( texture_atlas_t * self,
 
     depth = self->depth;
     charsize = sizeof(char);
+    self->version++;
     for( i=0; i<height; ++i )
     {
         memcpy( self->data+((y+i)*self->width + x ) * charsize * depth,
                 data + (i*stride) * charsize, width * charsize * depth  );
+        self->row_versions[y+i] = self->version;
     }
 }
 
 
+// ------------------------------------------- texture_atlas_get_dirty_rows ---
+int
+texture_atlas_get_dirty_rows( const texture_atlas_t * self,
+                              const uint32_t version,
+                              size_t * y,
+                              size_t * height )
+{
+    size_t start = *y;
+    size_t end;
+
+    assert( self );
+
+    while( start < self->height && self->row_versions[start] <= version )
+    {
+        start++;
+    }
+
+    if( start >= self->height )
+    {
+        return 0;
+    }
+
+    end = start + 1;
+
+    while( end < self->height && self->row_versions[end] > version )
+    {
+        end++;
+    }
+
+    *y = start;
+    *height = end - start;
+
+    return 1;
+}
+
+
 // ------------------------------------------------------ texture_atlas_fit ---
 int
 texture_atlas_fit( texture_atlas_t * self,
@@ -284,6 +341,7 @@ void
 texture_atlas_clear( texture_atlas_t * self )
 {
     ivec3 node = {{1,1,1}};
+    size_t i;
 
     assert( self );
     assert( self->data );
@@ -296,4 +354,38 @@ texture_atlas_clear( texture_atlas_t * self )
 
     vector_push_back( self->nodes, &node );
     memset( self->data, 0, self->width*self->height*self->depth );
+
+    self->version++;
+    for( i = 0; i < self->height; ++i )
+    {
+        self->row_versions[i] = self->version;
+    }
+}
+
+// -------------------------------------------------- texture_atlas_restore ---
+void
+texture_atlas_restore( texture_atlas_t * self,
+                       const ivec3 * nodes,
+                       const size_t count,
+                       const size_t used,
+                       const unsigned char * data )
+{
+    size_t i;
+
+    assert( self );
+    assert( self->data );
+    assert( nodes );
+    assert( count > 0 );
+    assert( data );
+
+    vector_clear( self->nodes );
+    vector_push_back_data( self->nodes, nodes, count );
+    self->used = used;
+    memcpy( self->data, data, self->width*self->height*self->depth );
+
+    self->version++;
+    for( i = 0; i < self->height; ++i )
+    {
+        self->row_versions[i] = self->version;
+    }
 }
@@ -45,6 +45,7 @@
 #define __TEXTURE_ATLAS_H__
 
 #include <stdlib.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -136,6 +137,26 @@ typedef struct texture_atlas_t
      */
     unsigned char * data;
 
+    /**
+     * Modification counter (incremented on each change of the data).
+     *
+     * Addition to Freetype GL.
+     */
+    uint32_t version;
+
+    /**
+     * Version of the last modification of each row (partial texture
+     * uploads).
+     */
+    uint32_t * row_versions;
+
+    /**
+     * Application data (not used by Freetype GL).
+     *
+     * Addition to Freetype GL.
+     */
+    void * user_data;
+
 } texture_atlas_t;
 
 
@@ -201,6 +222,20 @@ typedef struct texture_atlas_t
                             const unsigned char *data,
                             const size_t stride );
 
+/**
+ *  Find the next band of rows modified after a given version.
+ *  @param self    a texture atlas structure
+ *  @param version version of the last upload (0 to get all rows)
+ *  @param y       first row to check, set to the first modified row
+ *  @param height  set to the number of modified rows
+ *  @return        1 if modified rows were found, 0 otherwise
+ */
+  int
+  texture_atlas_get_dirty_rows( const texture_atlas_t * self,
+                                const uint32_t version,
+                                size_t * y,
+                                size_t * height );
+
 /**
  *  Remove all allocated regions from the atlas.
  *
@@ -210,6 +245,26 @@ typedef struct texture_atlas_t
   texture_atlas_clear( texture_atlas_t * self );
 
 
+/**
+ *  Restore the allocated regions and the data of the atlas (e.g. from a
+ *  glyph cache file).
+ *
+ *  Addition to Freetype GL.
+ *
+ *  @param self   a texture atlas structure
+ *  @param nodes  skyline nodes
+ *  @param count  number of nodes
+ *  @param used   allocated surface size
+ *  @param data   atlas data (width * height * depth bytes)
+ */
+  void
+  texture_atlas_restore( texture_atlas_t * self,
+                         const ivec3 * nodes,
+                         const size_t count,
+                         const size_t used,
+                         const unsigned char * data );
+
+
 /** @} */
 
 #ifdef __cplusplus
@@ -207,7 +207,7 @@ texture_glyph_new(void)
     self->t0        = 0.0;
     self->s1        = 0.0;
     self->t1        = 0.0;
-    self->kerning   = vector_new( sizeof(kerning_t) );
+    self->atlas     = NULL;
     return self;
 }
 
@@ -217,67 +217,121 @@ void
 texture_glyph_delete( texture_glyph_t *self )
 {
     assert( self );
-    vector_delete( self->kerning );
     free( self );
 }
 
-// ---------------------------------------------- texture_glyph_get_kerning ---
+// ---------------------------------------------- texture_font_kerning_hash ---
+static size_t
+texture_font_kerning_hash( uint32_t left, uint32_t right )
+{
+    uint32_t h = (left * 0x9E3779B1u) ^ (right * 0x85EBCA6Bu);
+
+    return h ^ (h >> 16);
+}
+
+// ---------------------------------------------- texture_font_kerning_slot ---
+static kerning_t *
+texture_font_kerning_slot( kerning_t * map, size_t size,
+                           uint32_t left, uint32_t right )
+{
+    size_t mask = size - 1;
+    size_t i = texture_font_kerning_hash( left, right ) & mask;
+
+    while( map[i].used && (map[i].left != left || map[i].right != right) )
+    {
+        i = (i + 1) & mask;
+    }
+
+    return &map[i];
+}
+
+// ----------------------------------------------- texture_font_get_kerning ---
 float
-texture_glyph_get_kerning( const texture_glyph_t * self,
-                           const char * codepoint )
+texture_font_get_kerning( texture_font_t * self,
+                          const texture_glyph_t * glyph,
+                          const char * codepoint )
 {
-    size_t i;
-    uint32_t ucodepoint = utf8_to_utf32( codepoint );
+    uint32_t left = utf8_to_utf32( codepoint );
+    uint32_t right = glyph->codepoint;
+    kerning_t *slot;
+    FT_Vector kerning;
 
     assert( self );
-    for( i=0; i<vector_size(self->kerning); ++i )
+    assert( glyph );
+
+    if( !self->kerning || !self->face || !FT_HAS_KERNING( self->face ) )
     {
-        kerning_t * kerning = (kerning_t *) vector_get( self->kerning, i );
-        if( kerning->codepoint == ucodepoint )
+        return 0;
+    }
+
+    /* Cached pair */
+    if( self->kerning_map )
+    {
+        slot = texture_font_kerning_slot( self->kerning_map, self->kerning_map_size, left, right );
+
+        if( slot->used )
         {
-            return kerning->kerning;
+            return slot->kerning;
         }
     }
-    return 0;
-}
 
+    /* Query FreeType */
+    FT_Get_Kerning( self->face,
+                    FT_Get_Char_Index( self->face, left ),
+                    FT_Get_Char_Index( self->face, right ),
+                    FT_KERNING_UNFITTED, &kerning );
 
-// ------------------------------------------ texture_font_generate_kerning ---
-void
-texture_font_generate_kerning( texture_font_t *self)
+    return texture_font_set_kerning( self, left, right,
+                                     kerning.x / (float)(HRESf*HRESf) );
+}
+
+// ----------------------------------------------- texture_font_set_kerning ---
+float
+texture_font_set_kerning( texture_font_t * self,
+                          uint32_t left,
+                          uint32_t right,
+                          float value )
 {
-    size_t i, j;
-    FT_UInt glyph_index, prev_index;
-    texture_glyph_t *glyph, *prev_glyph;
-    FT_Vector kerning;
+    size_t i;
+    kerning_t *slot;
 
     assert( self );
-    assert(self->library);
-    assert(self->face);
 
-    /* For each glyph couple combination, check if kerning is necessary */
-    /* Starts at index 1 since 0 is for the special background glyph */
-    for( i=1; i<self->glyphs->size; ++i )
+    /* Grow cache (load factor <= 0.5) */
+    if( (self->kerning_map_count + 1) * 2 > self->kerning_map_size )
     {
-        glyph = *(texture_glyph_t **) vector_get( self->glyphs, i );
-        glyph_index = FT_Get_Char_Index( self->face, glyph->codepoint );
-        vector_clear( glyph->kerning );
+        size_t size = self->kerning_map_size ? self->kerning_map_size * 2 : 256;
+        kerning_t *map = (kerning_t *) calloc( size, sizeof(kerning_t) );
 
-        for( j=1; j<self->glyphs->size; ++j )
+        //@appamics.CB: extra check
+        assert( map );
+
+        for( i = 0; i < self->kerning_map_size; ++i )
         {
-            prev_glyph = *(texture_glyph_t **) vector_get( self->glyphs, j );
-            prev_index = FT_Get_Char_Index( self->face, prev_glyph->codepoint );
-            FT_Get_Kerning( self->face, prev_index, glyph_index, FT_KERNING_UNFITTED, &kerning );
-            // printf("%c(%d)-%c(%d): %ld\n",
-            //       prev_glyph->codepoint, prev_glyph->codepoint,
-            //       glyph_index, glyph_index, kerning.x);
-            if( kerning.x )
+            if( self->kerning_map[i].used )
             {
-                kerning_t k = {prev_glyph->codepoint, kerning.x / (float)(HRESf*HRESf)};
-                vector_push_back( glyph->kerning, &k );
+                *texture_font_kerning_slot( map, size, self->kerning_map[i].left, self->kerning_map[i].right ) = self->kerning_map[i];
             }
         }
+
+        free( self->kerning_map );
+        self->kerning_map = map;
+        self->kerning_map_size = size;
+    }
+
+    slot = texture_font_kerning_slot( self->kerning_map, self->kerning_map_size, left, right );
+
+    if( !slot->used )
+    {
+        slot->left = left;
+        slot->right = right;
+        slot->used = 1;
+        self->kerning_map_count++;
     }
+
+    slot->kerning = value;
+
+    return value;
 }
 
 // ------------------------------------------------------ texture_font_init ---
@@ -293,6 +347,13 @@ texture_font_init(texture_font_t *self, FT_Library library)
             && self->memory.base && self->memory.size));
 
     self->glyphs = vector_new(sizeof(texture_glyph_t *));
+    self->glyph_map = NULL;
+    self->glyph_map_size = 0;
+    self->kerning_map = NULL;
+    self->kerning_map_size = 0;
+    self->kerning_map_count = 0;
+    self->atlas_full = NULL;
+    self->atlas_full_data = NULL;
     self->height = 0;
     self->ascender = 0;
     self->descender = 0;
@@ -445,20 +506,91 @@ texture_font_delete( texture_font_t *self )
     }
 
     vector_delete( self->glyphs );
+    free( self->glyph_map );
+    free( self->kerning_map );
     free( self );
 }
 
+// ------------------------------------------------ texture_font_glyph_hash ---
+static size_t
+texture_font_glyph_hash( uint32_t codepoint )
+{
+    /* Render mode and outline thickness share the slot chain of a codepoint */
+    uint32_t h = codepoint * 0x9E3779B1u;
+
+    return h ^ (h >> 16);
+}
+
+// ---------------------------------------------- texture_font_glyph_insert ---
+static void
+texture_font_glyph_insert( texture_font_t * self,
+                           texture_glyph_t * glyph )
+{
+    size_t mask = self->glyph_map_size - 1;
+    size_t i = texture_font_glyph_hash( glyph->codepoint ) & mask;
+
+    while( self->glyph_map[i] )
+    {
+        i = (i + 1) & mask;
+    }
+
+    self->glyph_map[i] = glyph;
+}
+
+// ------------------------------------------------- texture_font_add_glyph ---
+void
+texture_font_add_glyph( texture_font_t * self,
+                        texture_glyph_t * glyph )
+{
+    size_t i;
+
+    assert( self );
+    assert( glyph );
+
+    vector_push_back( self->glyphs, &glyph );
+
+    /* Grow lookup table (load factor <= 0.5) */
+    if( self->glyphs->size * 2 > self->glyph_map_size )
+    {
+        size_t size = self->glyph_map_size ? self->glyph_map_size * 2 : 64;
+        texture_glyph_t **map = (texture_glyph_t **) calloc( size, sizeof(texture_glyph_t *) );
+
+        //@appamics.CB: extra check
+        assert( map );
+
+        free( self->glyph_map );
+        self->glyph_map = map;
+        self->glyph_map_size = size;
+
+        for( i = 0; i < self->glyphs->size; ++i )
+        {
+            texture_font_glyph_insert( self, *(texture_glyph_t **) vector_get( self->glyphs, i ) );
+        }
+
+        return;
+    }
+
+    texture_font_glyph_insert( self, glyph );
+}
+
+// ------------------------------------------------ texture_font_find_glyph ---
 texture_glyph_t *
 texture_font_find_glyph( texture_font_t * self,
                          const char * codepoint )
 {
-    size_t i;
+    size_t i, mask;
     texture_glyph_t *glyph;
     uint32_t ucodepoint = utf8_to_utf32( codepoint );
 
-    for( i = 0; i < self->glyphs->size; ++i )
+    if( !self->glyph_map )
+    {
+        return NULL;
+    }
+
+    mask = self->glyph_map_size - 1;
+
+    for( i = texture_font_glyph_hash( ucodepoint ) & mask; (glyph = self->glyph_map[i]); i = (i + 1) & mask )
     {
-        glyph = *(texture_glyph_t **) vector_get( self->glyphs, i );
         // If codepoint is -1, we don't care about outline type or thickness
         if( (glyph->codepoint == ucodepoint) &&
             ((ucodepoint == UINT32_MAX) ||
@@ -472,6 +604,72 @@ texture_font_find_glyph( texture_font_t * self,
     return NULL;
 }
 
+// --------------------------------------------- texture_font_remove_glyphs ---
+size_t
+texture_font_remove_glyphs( texture_font_t * self,
+                            texture_atlas_t * atlas )
+{
+    size_t i = 0, removed = 0;
+    texture_glyph_t *glyph;
+
+    assert( self );
+
+    while( i < self->glyphs->size )
+    {
+        glyph = *(texture_glyph_t **) vector_get( self->glyphs, i );
+
+        if( glyph->atlas == atlas )
+        {
+            texture_glyph_delete( glyph );
+            vector_erase( self->glyphs, i );
+            removed++;
+        }
+        else
+        {
+            i++;
+        }
+    }
+
+    /* Rebuild lookup table */
+    if( removed && self->glyph_map )
+    {
+        memset( self->glyph_map, 0, self->glyph_map_size * sizeof(texture_glyph_t *) );
+
+        for( i = 0; i < self->glyphs->size; ++i )
+        {
+            texture_font_glyph_insert( self, *(texture_glyph_t **) vector_get( self->glyphs, i ) );
+        }
+    }
+
+    return removed;
+}
+
+// ------------------------------------------------ texture_font_get_region ---
+static ivec4
+texture_font_get_region( texture_font_t * self,
+                         const size_t width,
+                         const size_t height )
+{
+    ivec4 region = texture_atlas_get_region( self->atlas, width, height );
+    texture_atlas_t *atlas;
+
+    /* Continue on the next atlas page */
+    while( region.x < 0 && self->atlas_full )
+    {
+        atlas = self->atlas_full( self, self->atlas_full_data );
+
+        if( !atlas )
+        {
+            break;
+        }
+
+        self->atlas = atlas;
+        region = texture_atlas_get_region( self->atlas, width, height );
+    }
+
+    return region;
+}
+
 // ------------------------------------------------ texture_font_load_glyph ---
 int
 texture_font_load_glyph( texture_font_t * self,
@@ -506,8 +704,8 @@ texture_font_load_glyph( texture_font_t * self,
      */
     if( !codepoint )
     {
-        ivec4 region = texture_atlas_get_region( self->atlas, 5, 5 );
-        texture_glyph_t * glyph = texture_glyph_new( );
+        ivec4 region = texture_font_get_region( self, 5, 5 );
+        texture_glyph_t * glyph;
         static unsigned char data[4*4*3] = {-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
                                             -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
                                             -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
@@ -518,12 +716,14 @@ texture_font_load_glyph( texture_font_t * self,
             return 0;
         }
         texture_atlas_set_region( self->atlas, region.x, region.y, 4, 4, data, 0 );
+        glyph = texture_glyph_new( );
         glyph->codepoint = -1;
+        glyph->atlas = self->atlas;
         glyph->s0 = (region.x+2)/(float)self->atlas->width;
         glyph->t0 = (region.y+2)/(float)self->atlas->height;
         glyph->s1 = (region.x+3)/(float)self->atlas->width;
         glyph->t1 = (region.y+3)/(float)self->atlas->height;
-        vector_push_back( self->glyphs, &glyph );
+        texture_font_add_glyph( self, glyph );
         return 1;
     }
 
@@ -664,13 +864,22 @@ cleanup_stroker:
     padding.left = 1;
     padding.top = 1;
 
+    //@appamics.CB: room for the distance field (outline, shadow)
+    if( self->rendermode == RENDER_SIGNED_DISTANCE_FIELD )
+    {
+        padding.left = TEXTURE_FONT_SDF_SPREAD;
+        padding.top = TEXTURE_FONT_SDF_SPREAD;
+        padding.right = TEXTURE_FONT_SDF_SPREAD;
+        padding.bottom = TEXTURE_FONT_SDF_SPREAD;
+    }
+
     size_t src_w = ft_bitmap.width/self->atlas->depth;
     size_t src_h = ft_bitmap.rows;
 
     size_t tgt_w = src_w + padding.left + padding.right;
     size_t tgt_h = src_h + padding.top + padding.bottom;
 
-    region = texture_atlas_get_region( self->atlas, tgt_w, tgt_h );
+    region = texture_font_get_region( self, tgt_w, tgt_h );
 
     if ( region.x < 0 )
     {
@@ -693,7 +902,8 @@ cleanup_stroker:
 
     if( self->rendermode == RENDER_SIGNED_DISTANCE_FIELD )
     {
-        unsigned char *sdf = make_distance_mapb( buffer, tgt_w, tgt_h );
+        //@appamics.CB: same spread for all glyphs
+        unsigned char *sdf = make_distance_mapb_spread( buffer, tgt_w, tgt_h, TEXTURE_FONT_SDF_SPREAD );
         free( buffer );
         buffer = sdf;
     }
@@ -708,8 +918,16 @@ cleanup_stroker:
     glyph->height   = tgt_h;
     glyph->rendermode = self->rendermode;
     glyph->outline_thickness = self->outline_thickness;
+    glyph->atlas    = self->atlas;
     glyph->offset_x = ft_glyph_left;
     glyph->offset_y = ft_glyph_top;
+
+    //@appamics.CB: keep outline position (padded distance field)
+    if( self->rendermode == RENDER_SIGNED_DISTANCE_FIELD )
+    {
+        glyph->offset_x -= padding.left;
+        glyph->offset_y += padding.top;
+    }
     glyph->s0       = x/(float)self->atlas->width;
     glyph->t0       = y/(float)self->atlas->height;
     glyph->s1       = (x + glyph->width)/(float)self->atlas->width;
@@ -721,13 +939,11 @@ cleanup_stroker:
     glyph->advance_x = slot->advance.x / HRESf;
     glyph->advance_y = slot->advance.y / HRESf;
 
-    vector_push_back( self->glyphs, &glyph );
+    texture_font_add_glyph( self, glyph );
 
     if( self->rendermode != RENDER_NORMAL && self->rendermode != RENDER_SIGNED_DISTANCE_FIELD )
         FT_Done_Glyph( ft_glyph );
 
-    texture_font_generate_kerning( self );
-
     return 1;
 }
 
@@ -89,26 +89,42 @@ typedef enum rendermode_t
     RENDER_SIGNED_DISTANCE_FIELD
 } rendermode_t;
 
+/**
+ * Distance (pixels) covered by signed distance field glyphs on each side of
+ * the outline. Also the padding around each glyph.
+ *
+ * Addition to Freetype GL.
+ */
+#define TEXTURE_FONT_SDF_SPREAD 6
+
 
 /**
- * A structure that hold a kerning value relatively to a Unicode
- * codepoint.
+ * A structure that holds the kerning value of a pair of Unicode codepoints.
  *
- * This structure cannot be used alone since the (necessary) right
- * Unicode codepoint is implicitely held by the owner of this structure.
+ * Addition to Freetype GL: replaces the per glyph kerning vectors.
  */
 typedef struct kerning_t
 {
     /**
      * Left Unicode codepoint in the kern pair in UTF-32 LE encoding.
      */
-    uint32_t codepoint;
+    uint32_t left;
+
+    /**
+     * Right Unicode codepoint in the kern pair in UTF-32 LE encoding.
+     */
+    uint32_t right;
 
     /**
      * Kerning value (in fractional pixels).
      */
     float kerning;
 
+    /**
+     * Non-zero if the table slot is used.
+     */
+    int used;
+
 } kerning_t;
 
 
@@ -214,11 +230,6 @@ typedef struct texture_glyph_t
      */
     float t1;
 
-    /**
-     * A vector of kerning pairs relative to this glyph.
-     */
-    vector_t * kerning;
-
     /**
      * Mode this glyph was rendered
      */
@@ -229,6 +240,13 @@ typedef struct texture_glyph_t
      */
     float outline_thickness;
 
+    /**
+     * Atlas page holding the glyph bitmap.
+     *
+     * Addition to Freetype GL.
+     */
+    texture_atlas_t * atlas;
+
 } texture_glyph_t;
 
 
@@ -362,6 +380,52 @@ typedef struct texture_font_t
     int libraryShared;
     FT_Face face;
 
+    /**
+     * Glyph lookup table (open addressing, indexed by codepoint). Holds all
+     * glyphs of the glyphs vector.
+     *
+     * Addition to Freetype GL.
+     */
+    texture_glyph_t ** glyph_map;
+
+    /**
+     * Glyph lookup table size (power of two).
+     */
+    size_t glyph_map_size;
+
+    /**
+     * Kerning cache (open addressing, filled on first lookup of a pair).
+     *
+     * Addition to Freetype GL.
+     */
+    kerning_t * kerning_map;
+
+    /**
+     * Kerning cache size (power of two).
+     */
+    size_t kerning_map_size;
+
+    /**
+     * Number of cached kerning pairs.
+     */
+    size_t kerning_map_count;
+
+    /**
+     * Called if the current atlas is full. Returns the atlas to continue
+     * with (becomes the font atlas) or NULL if there is no space left.
+     *
+     * Note: has to return a different or emptied atlas to make progress.
+     *
+     * Addition to Freetype GL.
+     */
+    texture_atlas_t * (*atlas_full)( struct texture_font_t * self,
+                                     void * data );
+
+    /**
+     * User data passed to atlas_full.
+     */
+    void * atlas_full_data;
+
 } texture_font_t;
 
 
@@ -434,6 +498,41 @@ typedef struct texture_font_t
   texture_font_get_glyph( texture_font_t * self,
                           const char * codepoint );
 
+/**
+ * Find an already loaded glyph (constant time).
+ *
+ * @param self      A valid texture font
+ * @param codepoint Character codepoint in UTF-8 encoding.
+ *
+ * @return A pointer on the glyph or 0 if it was not loaded yet.
+ */
+  texture_glyph_t *
+  texture_font_find_glyph( texture_font_t * self,
+                           const char * codepoint );
+
+/**
+ * Add a glyph to the font (glyphs vector and lookup table).
+ *
+ * @param self  A valid texture font
+ * @param glyph Glyph owned by the font from now on.
+ */
+  void
+  texture_font_add_glyph( texture_font_t * self,
+                          texture_glyph_t * glyph );
+
+
+/**
+ * Remove all glyphs stored in an atlas (e.g. after the atlas was cleared).
+ *
+ * @param self  A valid texture font
+ * @param atlas Atlas of the glyphs to remove.
+ *
+ * @return Number of removed glyphs.
+ */
+  size_t
+  texture_font_remove_glyphs( texture_font_t * self,
+                              texture_atlas_t * atlas );
+
 
 /**
  * Request the loading of a given glyph.
@@ -464,14 +563,37 @@ typedef struct texture_font_t
 /**
  * Get the kerning between two horizontal glyphs.
  *
- * @param self      A valid texture glyph
+ * Pairs are queried from FreeType on first use and cached afterwards.
+ *
+ * @param self      A valid texture font
+ * @param glyph     A valid texture glyph of the font
  * @param codepoint Character codepoint of the peceding character in UTF-8 encoding.
  *
  * @return x kerning value
  */
 float
-texture_glyph_get_kerning( const texture_glyph_t * self,
-                           const char * codepoint );
+texture_font_get_kerning( texture_font_t * self,
+                          const texture_glyph_t * glyph,
+                          const char * codepoint );
+
+/**
+ * Set the kerning between two horizontal glyphs (e.g. restored from a glyph
+ * cache file).
+ *
+ * Addition to Freetype GL.
+ *
+ * @param self  A valid texture font
+ * @param left  UTF-32 codepoint of the preceding character
+ * @param right UTF-32 codepoint of the following character
+ * @param value x kerning value
+ *
+ * @return x kerning value
+ */
+float
+texture_font_set_kerning( texture_font_t * self,
+                          uint32_t left,
+                          uint32_t right,
+                          float value );
 
 
 /**
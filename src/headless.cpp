@@ -0,0 +1,470 @@
+#include "headless.h"
+
+#include <unistd.h>
+
+#define DEBUG_HEADLESS false
+
+//frame pacing without fixed timestep (ms)
+#define HEADLESS_FRAME_TIME (1000. / 60.)
+
+#define headless_assert(x) _headless_assert((void*)((x)), __LINE__)
+
+void _headless_assert(void* x, int line) {
+    if (x) return;
+    printf("ERROR: assertion failed on line %d\n", line);
+    int glError = glGetError();
+    if (glError != GL_NO_ERROR)  {
+        printf("ERROR: gl code: %x\n", glError);
+    }
+    EGLint err = eglGetError();
+    if (err != EGL_SUCCESS) {
+        printf("ERROR: egl code: %x\n", err);
+    }
+    assert(x);
+}
+
+//
+// AminoGfxHeadless
+//
+
+AminoGfxHeadless::AminoGfxHeadless(): AminoGfx(getFactory()->name) {
+    //empty
+}
+
+AminoGfxHeadless::~AminoGfxHeadless() {
+    if (!destroyed) {
+        destroyAminoGfxHeadless();
+    }
+}
+
+/**
+ * Get factory instance.
+ */
+AminoGfxHeadlessFactory* AminoGfxHeadless::getFactory() {
+    static AminoGfxHeadlessFactory *instance = NULL;
+
+    if (!instance) {
+        instance = new AminoGfxHeadlessFactory(New);
+    }
+
+    return instance;
+}
+
+/**
+ * Add class template to module exports.
+ */
+NAN_MODULE_INIT(AminoGfxHeadless::Init) {
+    AminoGfxHeadlessFactory *factory = getFactory();
+
+    AminoGfx::Init(target, factory);
+}
+
+/**
+ * JS object construction.
+ */
+NAN_METHOD(AminoGfxHeadless::New) {
+    AminoJSObject::createInstance(info, getFactory());
+}
+
+/**
+ * Setup JS instance.
+ */
+void AminoGfxHeadless::setup() {
+    if (DEBUG_HEADLESS) {
+        printf("AminoGfxHeadless.setup()\n");
+    }
+
+    //instance
+    addInstance();
+
+    //EGL display & context
+    initEGL();
+
+    //base class
+    AminoGfx::setup();
+}
+
+/**
+ * Initialize EGL without a native display.
+ */
+void AminoGfxHeadless::initEGL() {
+    EGLBoolean res;
+
+    //get an EGL display connection
+    if (display == EGL_NO_DISPLAY) {
+        //prefer Mesa surfaceless platform (no X11/Wayland/DRM needed)
+        PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+
+        if (getPlatformDisplay) {
+            display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, NULL, NULL);
+        }
+
+        if (display == EGL_NO_DISPLAY) {
+            display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+        }
+
+        headless_assert(display != EGL_NO_DISPLAY);
+
+        //initialize the EGL display connection
+        res = eglInitialize(display, NULL, NULL);
+
+        headless_assert(res != EGL_FALSE);
+
+        if (DEBUG_HEADLESS) {
+            printf("-> EGL initialized\n");
+        }
+    }
+
+    //get an appropriate EGL frame buffer configuration
+    static const EGLint attribute_list[] = {
+        //RGBA
+        EGL_RED_SIZE, 8,
+        EGL_GREEN_SIZE, 8,
+        EGL_BLUE_SIZE, 8,
+        EGL_ALPHA_SIZE, 8,
+
+        //OpenGL ES 2.0
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_ES2_BIT,
+
+        //buffers
+        EGL_STENCIL_SIZE, 8,
+        EGL_DEPTH_SIZE, 16,
+
+        //offscreen
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+
+        EGL_NONE
+    };
+
+    EGLint num_config = 0;
+
+    res = eglChooseConfig(display, attribute_list, &config, 1, &num_config);
+
+    headless_assert(res != EGL_FALSE);
+    headless_assert(num_config > 0);
+
+    //choose OpenGL ES 2
+    res = eglBindAPI(EGL_OPENGL_ES_API);
+
+    headless_assert(res != EGL_FALSE);
+
+    //create an EGL rendering context
+    static const EGLint context_attributes[] = {
+        EGL_CONTEXT_CLIENT_VERSION, 2,
+        EGL_NONE
+    };
+
+    context = eglCreateContext(display, config, EGL_NO_CONTEXT, context_attributes);
+
+    headless_assert(context != EGL_NO_CONTEXT);
+}
+
+/**
+ * Destroy EGL instance.
+ */
+void AminoGfxHeadless::destroy() {
+    if (destroyed) {
+        return;
+    }
+
+    //instance
+    destroyAminoGfxHeadless();
+
+    //destroy basic instance
+    AminoGfx::destroy();
+}
+
+/**
+ * Destroy EGL instance.
+ */
+void AminoGfxHeadless::destroyAminoGfxHeadless() {
+    if (display != EGL_NO_DISPLAY) {
+        if (context != EGL_NO_CONTEXT) {
+            eglDestroyContext(display, context);
+            context = EGL_NO_CONTEXT;
+        }
+
+        if (surface != EGL_NO_SURFACE) {
+            eglDestroySurface(display, surface);
+            surface = EGL_NO_SURFACE;
+        }
+    }
+
+    removeInstance();
+
+    if (DEBUG_HEADLESS) {
+        printf("Destroyed headless instance. Left=%i\n", instanceCount);
+    }
+
+    //shared display
+    if (instanceCount == 0 && display != EGL_NO_DISPLAY) {
+        eglTerminate(display);
+        display = EGL_NO_DISPLAY;
+    }
+}
+
+/**
+ * Add EGL properties.
+ */
+void AminoGfxHeadless::populateRuntimeProperties(v8::Local<v8::Object> &obj) {
+    AminoGfx::populateRuntimeProperties(obj);
+
+    //EGL
+    Nan::Set(obj, Nan::New("eglVendor").ToLocalChecked(), Nan::New(std::string(eglQueryString(display, EGL_VENDOR))).ToLocalChecked());
+    Nan::Set(obj, Nan::New("eglVersion").ToLocalChecked(), Nan::New(std::string(eglQueryString(display, EGL_VERSION))).ToLocalChecked());
+    Nan::Set(obj, Nan::New("headless").ToLocalChecked(), Nan::True());
+}
+
+/**
+ * Create the offscreen surface.
+ */
+void AminoGfxHeadless::initRenderer() {
+    if (DEBUG_HEADLESS) {
+        printf("initRenderer()\n");
+    }
+
+    //base
+    AminoGfx::initRenderer();
+
+    //pbuffer (uses current size)
+    surfaceW = propW->value;
+    surfaceH = propH->value;
+
+    const EGLint pbuffer_attributes[] = {
+        EGL_WIDTH, surfaceW,
+        EGL_HEIGHT, surfaceH,
+        EGL_NONE
+    };
+
+    surface = eglCreatePbufferSurface(display, config, pbuffer_attributes);
+
+    headless_assert(surface != EGL_NO_SURFACE);
+
+    updatePosition(0, 0);
+
+    viewportW = surfaceW;
+    viewportH = surfaceH;
+    viewportChanged = true;
+
+    //activate context (needed by JS code to create shaders)
+    EGLBoolean res = eglMakeCurrent(display, surface, surface, context);
+
+    headless_assert(res != EGL_FALSE);
+}
+
+/**
+ * Start rendering.
+ */
+void AminoGfxHeadless::start() {
+    //ready to get control back to JS code
+    ready();
+
+    //detach context from main thread
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+}
+
+/**
+ * Bind the OpenGL context.
+ */
+bool AminoGfxHeadless::bindContext() {
+    if (surface == EGL_NO_SURFACE) {
+        return false;
+    }
+
+    EGLBoolean res = eglMakeCurrent(display, surface, surface, context);
+
+    headless_assert(res == EGL_TRUE);
+
+    return true;
+}
+
+/**
+ * Frame is ready.
+ */
+void AminoGfxHeadless::renderingDone() {
+    //Note: no-op on single buffered pbuffers
+    eglSwapBuffers(display, surface);
+
+    //fixed timestep: render as fast as possible
+    if (fixedTimestep > 0) {
+        return;
+    }
+
+    //limit frame rate (no vsync available)
+    double now = getTime();
+    double wait = HEADLESS_FRAME_TIME - (now - lastFrameTime);
+
+    if (wait > 0 && lastFrameTime > 0) {
+        usleep(wait * 1000);
+        now = getTime();
+    }
+
+    lastFrameTime = now;
+}
+
+/**
+ * Handle system events.
+ */
+void AminoGfxHeadless::handleSystemEvents() {
+    //no input devices
+}
+
+/**
+ * Update the window size.
+ *
+ * Note: has to be called on main thread
+ */
+void AminoGfxHeadless::updateWindowSize() {
+    //size is fixed after surface creation
+    if (surface == EGL_NO_SURFACE) {
+        return;
+    }
+
+    propW->setValue(surfaceW);
+    propH->setValue(surfaceH);
+}
+
+/**
+ * Update the window position.
+ *
+ * Note: has to be called on main thread
+ */
+void AminoGfxHeadless::updateWindowPosition() {
+    //not supported
+    propX->setValue(0);
+    propY->setValue(0);
+}
+
+/**
+ * Update the title.
+ *
+ * Note: has to be called on main thread
+ */
+void AminoGfxHeadless::updateWindowTitle() {
+    //not supported
+}
+
+/**
+ * Shared atlas texture has changed.
+ */
+void AminoGfxHeadless::atlasTextureHasChanged(texture_atlas_t *atlas) {
+    //check single instance case
+    if (instanceCount == 1) {
+        return;
+    }
+
+    //run on main thread
+    enqueueJSCallbackUpdate(static_cast<jsUpdateCallback>(&AminoGfxHeadless::atlasTextureHasChangedHandler), NULL, atlas);
+}
+
+/**
+ * Handle on main thread.
+ */
+void AminoGfxHeadless::atlasTextureHasChangedHandler(JSCallbackUpdate *update) {
+    AminoGfx *gfx = static_cast<AminoGfx *>(update->obj);
+    texture_atlas_t *atlas = (texture_atlas_t *)update->data;
+
+    for (auto const &item : instances) {
+        if (gfx == item) {
+            continue;
+        }
+
+        static_cast<AminoGfxHeadless *>(item)->updateAtlasTexture(atlas);
+    }
+}
+
+/**
+ * Create video player.
+ */
+AminoVideoPlayer* AminoGfxHeadless::createVideoPlayer(AminoTexture *texture, AminoVideo *video) {
+    return new AminoHeadlessVideoPlayer(texture, video);
+}
+
+//static initializers
+EGLDisplay AminoGfxHeadless::display = EGL_NO_DISPLAY;
+
+//
+// AminoGfxHeadlessFactory
+//
+
+/**
+ * Create AminoGfx factory.
+ */
+AminoGfxHeadlessFactory::AminoGfxHeadlessFactory(Nan::FunctionCallback callback): AminoJSObjectFactory("AminoGfx", callback) {
+    //empty
+}
+
+/**
+ * Create AminoGfx instance.
+ */
+AminoJSObject* AminoGfxHeadlessFactory::create() {
+    return new AminoGfxHeadless();
+}
+
+//
+// AminoHeadlessVideoPlayer
+//
+
+AminoHeadlessVideoPlayer::AminoHeadlessVideoPlayer(AminoTexture *texture, AminoVideo *video): AminoVideoPlayer(texture, video) {
+    //empty
+}
+
+/**
+ * Init video stream.
+ *
+ * Note: called on main thread.
+ */
+bool AminoHeadlessVideoPlayer::initStream() {
+    lastError = "video playback not supported in headless mode";
+
+    return false;
+}
+
+void AminoHeadlessVideoPlayer::init() {
+    //not supported
+}
+
+void AminoHeadlessVideoPlayer::initVideoTexture() {
+    //not supported
+}
+
+void AminoHeadlessVideoPlayer::updateVideoTexture(GLContext *ctx) {
+    //not supported
+}
+
+double AminoHeadlessVideoPlayer::getMediaTime() {
+    return -1;
+}
+
+double AminoHeadlessVideoPlayer::getDuration() {
+    return -1;
+}
+
+double AminoHeadlessVideoPlayer::getFramerate() {
+    return -1;
+}
+
+void AminoHeadlessVideoPlayer::stopPlayback() {
+    //not supported
+}
+
+bool AminoHeadlessVideoPlayer::pausePlayback() {
+    return false;
+}
+
+bool AminoHeadlessVideoPlayer::resumePlayback() {
+    return false;
+}
+
+// ========== Event Callbacks ===========
+
+NAN_MODULE_INIT(InitAll) {
+    //main class
+    AminoGfxHeadless::Init(target);
+
+    //amino classes
+    AminoGfx::InitClasses(target);
+}
+
+//entry point
+NODE_MODULE(aminonative, InitAll)
@@ -0,0 +1,85 @@
+#ifndef _AMINO_HEADLESS_H
+#define _AMINO_HEADLESS_H
+
+#include "base.h"
+#include "renderer.h"
+
+class AminoGfxHeadlessFactory : public AminoJSObjectFactory {
+public:
+    AminoGfxHeadlessFactory(Nan::FunctionCallback callback);
+
+    AminoJSObject* create() override;
+};
+
+/**
+ * Headless AminoGfx implementation (offscreen EGL pbuffer).
+ */
+class AminoGfxHeadless : public AminoGfx {
+public:
+    AminoGfxHeadless();
+    ~AminoGfxHeadless();
+
+    static AminoGfxHeadlessFactory* getFactory();
+    static NAN_MODULE_INIT(Init);
+
+private:
+    static EGLDisplay display;
+    EGLContext context = EGL_NO_CONTEXT;
+    EGLSurface surface = EGL_NO_SURFACE;
+    EGLConfig config;
+
+    //surface size (fixed after start)
+    int32_t surfaceW = 0;
+    int32_t surfaceH = 0;
+
+    //frame pacing
+    double lastFrameTime = 0;
+
+    static NAN_METHOD(New);
+
+    void setup() override;
+    void initEGL();
+
+    void destroy() override;
+    void destroyAminoGfxHeadless();
+
+    void populateRuntimeProperties(v8::Local<v8::Object> &obj) override;
+    void initRenderer() override;
+
+    void start() override;
+    bool bindContext() override;
+    void renderingDone() override;
+    void handleSystemEvents() override;
+
+    void updateWindowSize() override;
+    void updateWindowPosition() override;
+    void updateWindowTitle() override;
+
+    void atlasTextureHasChanged(texture_atlas_t *atlas) override;
+    void atlasTextureHasChangedHandler(JSCallbackUpdate *update);
+
+    AminoVideoPlayer *createVideoPlayer(AminoTexture *texture, AminoVideo *video) override;
+};
+
+/**
+ * Headless video player (not supported).
+ */
+class AminoHeadlessVideoPlayer : public AminoVideoPlayer {
+public:
+    AminoHeadlessVideoPlayer(AminoTexture *texture, AminoVideo *video);
+
+    bool initStream() override;
+    void init() override;
+    void initVideoTexture() override;
+    void updateVideoTexture(GLContext *ctx) override;
+
+    //metadata
+    double getMediaTime() override;
+    double getDuration() override;
+    double getFramerate() override;
+    void stopPlayback() override;
+    bool pausePlayback() override;
+    bool resumePlayback() override;
+};
+
+#endif
@@ -0,0 +1,228 @@
+#include "hittest.h"
+
+#include <algorithm>
+#include <cmath>
+
+//
+// AminoHitIndex
+//
+
+AminoHitIndex::AminoHitIndex() {
+    //empty
+}
+
+/**
+ * Check if the index is used.
+ *
+ * Note: nodes are only recorded after the first query.
+ */
+bool AminoHitIndex::isEnabled() {
+    return enabled.load(std::memory_order_relaxed);
+}
+
+/**
+ * Enable recording.
+ */
+void AminoHitIndex::enable() {
+    enabled = true;
+}
+
+/**
+ * Start a new frame.
+ */
+void AminoHitIndex::begin(GLfloat w, GLfloat h) {
+    backEntries.clear();
+
+    //grid
+    backGridW = std::max(1, (int32_t)ceilf(w / CELL_SIZE));
+    backGridH = std::max(1, (int32_t)ceilf(h / CELL_SIZE));
+
+    std::size_t count = backGridW * backGridH;
+
+    if (backCells.size() != count) {
+        backCells.resize(count);
+    }
+
+    for (auto &cell : backCells) {
+        cell.clear();
+    }
+}
+
+/**
+ * Add a drawn node.
+ *
+ * Returns the entry index.
+ */
+int32_t AminoHitIndex::add(AminoNode *node, const GLfloat *matrix, const GLfloat local[4], const GLfloat screen[4], int32_t clip) {
+    amino_hit_entry_t entry;
+    uint32_t index = backEntries.size();
+
+    entry.node = node;
+
+    //x/y part of the 4x4 matrix
+    entry.m[0] = matrix[0];
+    entry.m[1] = matrix[1];
+    entry.m[2] = matrix[4];
+    entry.m[3] = matrix[5];
+    entry.m[4] = matrix[12];
+    entry.m[5] = matrix[13];
+
+    for (int i = 0; i < 4; i++) {
+        entry.local[i] = local[i];
+        entry.screen[i] = screen[i];
+    }
+
+    entry.clip = clip;
+
+    backEntries.push_back(entry);
+
+    //add to cells
+    if (screen[2] < screen[0] || screen[3] < screen[1]) {
+        //empty
+        return index;
+    }
+
+    int32_t cx1 = std::max(0, (int32_t)floorf(screen[0] / CELL_SIZE));
+    int32_t cy1 = std::max(0, (int32_t)floorf(screen[1] / CELL_SIZE));
+    int32_t cx2 = std::min(backGridW - 1, (int32_t)floorf(screen[2] / CELL_SIZE));
+    int32_t cy2 = std::min(backGridH - 1, (int32_t)floorf(screen[3] / CELL_SIZE));
+
+    for (int32_t cy = cy1; cy <= cy2; cy++) {
+        for (int32_t cx = cx1; cx <= cx2; cx++) {
+            backCells[cy * backGridW + cx].push_back(index);
+        }
+    }
+
+    return index;
+}
+
+/**
+ * Publish the index of the rendered frame.
+ *
+ * Note: invalid if the scene could not be mapped to screen coordinates.
+ */
+void AminoHitIndex::publish(bool valid) {
+    lock.lock();
+
+    std::swap(entries, backEntries);
+    std::swap(cells, backCells);
+    std::swap(gridW, backGridW);
+    std::swap(gridH, backGridH);
+
+    this->valid = valid;
+    destroyedNodes.clear();
+
+    lock.unlock();
+}
+
+/**
+ * Get the nodes at a screen position (topmost first).
+ *
+ * Returns false if no index is available.
+ */
+bool AminoHitIndex::query(GLfloat x, GLfloat y, std::vector<amino_hit_t> &res) {
+    std::lock_guard<std::mutex> guard(lock);
+
+    if (!valid) {
+        return false;
+    }
+
+    res.clear();
+
+    //cell
+    int32_t cx = (int32_t)floorf(x / CELL_SIZE);
+    int32_t cy = (int32_t)floorf(y / CELL_SIZE);
+
+    if (cx < 0 || cy < 0 || cx >= gridW || cy >= gridH) {
+        return true;
+    }
+
+    std::vector<uint32_t> &cell = cells[cy * gridW + cx];
+
+    //reverse drawing order
+    for (auto it = cell.rbegin(); it != cell.rend(); ++it) {
+        amino_hit_entry_t &entry = entries[*it];
+
+        //screen bounds
+        if (x < entry.screen[0] || x > entry.screen[2] || y < entry.screen[1] || y > entry.screen[3]) {
+            continue;
+        }
+
+        //removed
+        if (!destroyedNodes.empty() && destroyedNodes.find(entry.node) != destroyedNodes.end()) {
+            continue;
+        }
+
+        //local bounds
+        GLfloat lx, ly;
+
+        if (!toLocal(entry, x, y, lx, ly)) {
+            continue;
+        }
+
+        if (lx < entry.local[0] || lx > entry.local[2] || ly < entry.local[1] || ly > entry.local[3]) {
+            continue;
+        }
+
+        //clipping ancestors
+        bool clipped = false;
+
+        for (int32_t clip = entry.clip; clip >= 0; clip = entries[clip].clip) {
+            amino_hit_entry_t &clipEntry = entries[clip];
+            GLfloat clipX, clipY;
+
+            if (!toLocal(clipEntry, x, y, clipX, clipY) ||
+                clipX < clipEntry.local[0] || clipX >= clipEntry.local[2] || clipY < clipEntry.local[1] || clipY >= clipEntry.local[3]) {
+                clipped = true;
+                break;
+            }
+        }
+
+        if (clipped) {
+            continue;
+        }
+
+        amino_hit_t hit = { entry.node, lx, ly };
+
+        res.push_back(hit);
+    }
+
+    return true;
+}
+
+/**
+ * Node was destroyed.
+ *
+ * Note: called on main thread.
+ */
+void AminoHitIndex::nodeDestroyed(AminoNode *node) {
+    lock.lock();
+
+    if (valid) {
+        destroyedNodes.insert(node);
+    }
+
+    lock.unlock();
+}
+
+/**
+ * Convert a screen position to local coordinates.
+ *
+ * Returns false if the node is not invertible (e.g. rotated by 90 degrees around x or y axis).
+ */
+bool AminoHitIndex::toLocal(const amino_hit_entry_t &entry, GLfloat x, GLfloat y, GLfloat &lx, GLfloat &ly) {
+    const GLfloat *m = entry.m;
+    GLfloat det = m[0] * m[3] - m[2] * m[1];
+
+    if (det == 0) {
+        return false;
+    }
+
+    GLfloat dx = x - m[4];
+    GLfloat dy = y - m[5];
+
+    lx = (m[3] * dx - m[2] * dy) / det;
+    ly = (m[0] * dy - m[1] * dx) / det;
+
+    return true;
+}
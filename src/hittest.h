@@ -0,0 +1,77 @@
+#ifndef _AMINO_HITTEST_H
+#define _AMINO_HITTEST_H
+
+#include "gfx.h"
+
+#include <stdint.h>
+#include <vector>
+#include <unordered_set>
+#include <mutex>
+#include <atomic>
+
+class AminoNode;
+
+/**
+ * Node drawn in the last frame.
+ */
+typedef struct {
+    AminoNode *node;
+    GLfloat m[6];      //2D affine local to screen transform (column-major 2x3)
+    GLfloat local[4];  //local bounds (x1, y1, x2, y2)
+    GLfloat screen[4]; //screen bounds (x1, y1, x2, y2), clipped
+    int32_t clip;      //entry of nearest clipping ancestor (-1 if none)
+} amino_hit_entry_t;
+
+/**
+ * Hit test result.
+ */
+typedef struct {
+    AminoNode *node;
+    GLfloat x; //local coordinate
+    GLfloat y;
+} amino_hit_t;
+
+/**
+ * Spatial index of the rendered nodes (uniform grid in screen coordinates).
+ *
+ * Built on the rendering thread while drawing, queried on the main thread.
+ */
+class AminoHitIndex {
+public:
+    AminoHitIndex();
+
+    //rendering thread
+    bool isEnabled();
+    void begin(GLfloat w, GLfloat h);
+    int32_t add(AminoNode *node, const GLfloat *matrix, const GLfloat local[4], const GLfloat screen[4], int32_t clip);
+    void publish(bool valid);
+
+    //main thread
+    void enable();
+    bool query(GLfloat x, GLfloat y, std::vector<amino_hit_t> &res);
+    void nodeDestroyed(AminoNode *node);
+
+private:
+    static const int CELL_SIZE = 64;
+
+    std::atomic<bool> enabled { false };
+
+    //index being built (rendering thread)
+    std::vector<amino_hit_entry_t> backEntries;
+    std::vector<std::vector<uint32_t>> backCells;
+    int32_t backGridW = 0;
+    int32_t backGridH = 0;
+
+    //published index
+    std::mutex lock;
+    bool valid = false;
+    std::vector<amino_hit_entry_t> entries;
+    std::vector<std::vector<uint32_t>> cells;
+    int32_t gridW = 0;
+    int32_t gridH = 0;
+    std::unordered_set<AminoNode *> destroyedNodes;
+
+    static bool toLocal(const amino_hit_entry_t &entry, GLfloat x, GLfloat y, GLfloat &lx, GLfloat &ly);
+};
+
+#endif
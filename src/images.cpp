@@ -106,6 +106,8 @@ public:
      * Async running code.
      */
     void Execute() {
+        TRACE_SCOPE("decodeImage");
+
         if (DEBUG_THREADS) {
             uv_thread_t threadId = uv_thread_self();
 
@@ -1387,6 +1389,13 @@ void AminoTexture::handleVideoPlayerInitDone(JSCallbackUpdate *update) {
     }
 }
 
+/**
+ * Check if the texture is updated by a video player.
+ */
+bool AminoTexture::hasVideo() {
+    return videoLockUsed;
+}
+
 /**
  * Prepare the texture (on rendering thread).
  *
@@ -1401,6 +1410,11 @@ void AminoTexture::prepareTexture(GLContext *ctx) {
 
     if (videoPlayer) {
         videoPlayer->updateVideoTexture(ctx);
+
+        //keep rendering new frames while playing
+        if (videoPlayer->isPlaying() && !videoPlayer->isPaused() && eventHandler) {
+            (static_cast<AminoGfx *>(eventHandler))->invalidateScene();
+        }
     }
 
     uv_mutex_unlock(&videoLock);
@@ -1626,7 +1640,12 @@ void AminoTexture::createTextureFromFont(AsyncValueUpdate *update, int state) {
         assert(eventHandler);
 
         //use current font texture
+        fontSize->font->glyphLock.lock();
+
         texture_atlas_t *atlas = fontSize->fontTexture->atlas;
+
+        fontSize->font->glyphLock.unlock();
+
         bool newTexture;
         GLuint textureId = (static_cast<AminoGfx *>(eventHandler))->getAtlasTexture(atlas, true, newTexture).textureId;
 
@@ -90,6 +90,7 @@ public:
     //video
     void initVideoTexture();
     void videoPlayerInitDone();
+    bool hasVideo();
     void prepareTexture(GLContext *ctx);
     void fireVideoEvent(std::string event);
 
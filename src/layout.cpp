@@ -0,0 +1,463 @@
+#include "layout.h"
+#include "base.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+#define DEBUG_LAYOUT false
+
+//layout cache limits (texts longer than the max length are not cached)
+#define LAYOUT_CACHE_ENTRIES 256
+#define LAYOUT_CACHE_MAX_LENGTH 128
+
+//
+// amino_layout_key_t
+//
+
+/**
+ * Compare keys.
+ */
+bool amino_layout_key_t::operator==(const amino_layout_key_t &other) const {
+    return fontTexture == other.fontTexture && scale == other.scale && wrap == other.wrap && width == other.width && maxLines == other.maxLines && str == other.str;
+}
+
+/**
+ * Hash of a key.
+ */
+std::size_t amino_layout_key_hash_t::operator()(const amino_layout_key_t &key) const {
+    std::size_t hash = std::hash<std::string>()(key.str);
+
+    hash = hash * 31 + std::hash<void *>()(key.fontTexture);
+    hash = hash * 31 + std::hash<float>()(key.scale);
+    hash = hash * 31 + std::hash<float>()(key.width);
+    hash = hash * 31 + key.wrap;
+    hash = hash * 31 + key.maxLines;
+
+    return hash;
+}
+
+//
+// AminoLayoutCache
+//
+
+AminoLayoutCache::AminoLayoutCache() {
+    //empty
+}
+
+AminoLayoutCache::~AminoLayoutCache() {
+    for (auto const &entry : entries) {
+        delete entry;
+    }
+}
+
+/**
+ * Check if a layout can be cached.
+ */
+bool AminoLayoutCache::isCacheable(amino_text_layout_t *layout) {
+    return layout->str.length() <= LAYOUT_CACHE_MAX_LENGTH;
+}
+
+/**
+ * Get the key of a layout.
+ */
+void AminoLayoutCache::initKey(amino_layout_key_t &key, amino_text_layout_t *layout) {
+    key.fontTexture = layout->fontTexture;
+    key.scale = layout->scale;
+    key.wrap = layout->wrap;
+    key.width = layout->wrap == AminoText::WRAP_NONE ? 0:layout->width; //not used
+    key.maxLines = layout->maxLines;
+    key.str = layout->str;
+}
+
+/**
+ * Copy a cached layout.
+ *
+ * Returns false if there is no valid entry.
+ *
+ * Note: glyphLock of the font has to be locked.
+ */
+bool AminoLayoutCache::get(amino_text_layout_t *layout) {
+    if (!isCacheable(layout)) {
+        return false;
+    }
+
+    amino_layout_key_t key;
+
+    initKey(key, layout);
+
+    std::lock_guard<std::mutex> guard(lock);
+
+    auto it = index.find(key);
+
+    if (it == index.end()) {
+        misses++;
+
+        return false;
+    }
+
+    amino_layout_entry_t *entry = *it->second;
+
+    //check evicted glyphs
+    for (auto const &page : entry->pages) {
+        if (page.evictions != page.page->evictions.load()) {
+            removeEntry(it->second);
+            misses++;
+
+            return false;
+        }
+    }
+
+    //most recently used
+    entries.splice(entries.begin(), entries, it->second);
+    hits++;
+
+    //copy
+    vertex_buffer_t *buffer = layout->buffer;
+
+    if (!entry->items.empty()) {
+        vector_push_back_data(buffer->vertices, entry->vertices.data(), entry->vertices.size() / buffer->vertices->item_size);
+        vector_push_back_data(buffer->indices, entry->indices.data(), entry->indices.size() / buffer->indices->item_size);
+        vector_push_back_data(buffer->items, entry->items.data(), entry->items.size() / buffer->items->item_size);
+    }
+
+    uint32_t frame = AminoFont::getFrame();
+
+    for (auto const &page : entry->pages) {
+        //used by layout (prevents eviction in this frame)
+        page.page->lastUsed = frame;
+    }
+
+    layout->pages = entry->pages;
+    layout->glyphPages = entry->glyphPages;
+    std::memcpy(layout->bounds, entry->bounds, sizeof layout->bounds);
+    layout->lineNr = entry->lineNr;
+    layout->lineW = entry->lineW;
+
+    return true;
+}
+
+/**
+ * Add a layout.
+ *
+ * Note: glyphLock of the font has to be locked.
+ */
+void AminoLayoutCache::put(amino_text_layout_t *layout) {
+    if (!isCacheable(layout)) {
+        return;
+    }
+
+    amino_layout_entry_t *entry = new amino_layout_entry_t();
+
+    initKey(entry->key, layout);
+    entry->font = layout->font;
+
+    //copy
+    vertex_buffer_t *buffer = layout->buffer;
+    uint8_t *vertices = (uint8_t *)buffer->vertices->items;
+    uint8_t *indices = (uint8_t *)buffer->indices->items;
+    uint8_t *items = (uint8_t *)buffer->items->items;
+
+    entry->vertices.assign(vertices, vertices + buffer->vertices->size * buffer->vertices->item_size);
+    entry->indices.assign(indices, indices + buffer->indices->size * buffer->indices->item_size);
+    entry->items.assign(items, items + buffer->items->size * buffer->items->item_size);
+
+    entry->pages = layout->pages;
+    entry->glyphPages = layout->glyphPages;
+    std::memcpy(entry->bounds, layout->bounds, sizeof entry->bounds);
+    entry->lineNr = layout->lineNr;
+    entry->lineW = layout->lineW;
+
+    std::lock_guard<std::mutex> guard(lock);
+
+    //replace
+    auto it = index.find(entry->key);
+
+    if (it != index.end()) {
+        removeEntry(it->second);
+    }
+
+    entries.push_front(entry);
+    index[entry->key] = entries.begin();
+
+    //limit
+    while (entries.size() > LAYOUT_CACHE_ENTRIES) {
+        removeEntry(std::prev(entries.end()));
+    }
+}
+
+/**
+ * Remove all layouts of a font.
+ *
+ * Note: called before the font is destroyed.
+ */
+void AminoLayoutCache::removeFont(AminoFont *font) {
+    std::lock_guard<std::mutex> guard(lock);
+
+    for (auto it = entries.begin(); it != entries.end();) {
+        auto next = std::next(it);
+
+        if ((*it)->font == font) {
+            removeEntry(it);
+        }
+
+        it = next;
+    }
+}
+
+/**
+ * Remove an entry.
+ *
+ * Note: lock has to be locked.
+ */
+void AminoLayoutCache::removeEntry(std::list<amino_layout_entry_t *>::iterator it) {
+    amino_layout_entry_t *entry = *it;
+
+    index.erase(entry->key);
+    entries.erase(it);
+
+    delete entry;
+}
+
+/**
+ * Get the cache statistics.
+ */
+void AminoLayoutCache::getStats(v8::Local<v8::Object> &obj) {
+    lock.lock();
+
+    uint32_t count = entries.size();
+    uint32_t hits = this->hits;
+    uint32_t misses = this->misses;
+
+    lock.unlock();
+
+    v8::Local<v8::Object> cacheObj = Nan::New<v8::Object>();
+
+    Nan::Set(cacheObj, Nan::New("entries").ToLocalChecked(), Nan::New(count));
+    Nan::Set(cacheObj, Nan::New("hits").ToLocalChecked(), Nan::New(hits));
+    Nan::Set(cacheObj, Nan::New("misses").ToLocalChecked(), Nan::New(misses));
+    Nan::Set(obj, Nan::New("layoutCache").ToLocalChecked(), cacheObj);
+}
+
+//
+// AminoLayoutPool
+//
+
+AminoLayoutPool::AminoLayoutPool() {
+    //empty
+}
+
+AminoLayoutPool::~AminoLayoutPool() {
+    stop();
+}
+
+/**
+ * Start the worker threads.
+ *
+ * Note: called before the rendering thread starts.
+ */
+void AminoLayoutPool::start(AminoGfx *gfx, uint32_t threadCount) {
+    if (running || threadCount == 0) {
+        return;
+    }
+
+    this->gfx = gfx;
+    running = true;
+
+    for (uint32_t i = 0; i < threadCount; i++) {
+        uv_thread_t thread;
+        int res = uv_thread_create(&thread, workerThread, this);
+
+        assert(res == 0);
+
+        threads.push_back(thread);
+    }
+
+    if (DEBUG_LAYOUT) {
+        printf("-> layout workers: %i\n", (int)threadCount);
+    }
+}
+
+/**
+ * Stop the worker threads and free all layouts.
+ *
+ * Note: called after the rendering thread has ended.
+ */
+void AminoLayoutPool::stop() {
+    if (!running) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+
+        running = false;
+        queueCondition.notify_all();
+    }
+
+    for (auto &thread : threads) {
+        int res = uv_thread_join(&thread);
+
+        assert(res == 0);
+    }
+
+    threads.clear();
+
+    //free
+    for (auto const &layout : queue) {
+        delete layout;
+    }
+
+    for (auto const &layout : done) {
+        delete layout;
+    }
+
+    queue.clear();
+    done.clear();
+}
+
+/**
+ * Check if layouts are handled by workers.
+ */
+bool AminoLayoutPool::isRunning() {
+    return running;
+}
+
+/**
+ * Queue a layout.
+ *
+ * A queued layout of the same text is replaced.
+ */
+void AminoLayoutPool::add(amino_text_layout_t *layout) {
+    std::lock_guard<std::mutex> guard(lock);
+
+    for (auto &item : queue) {
+        if (item->text == layout->text) {
+            delete item;
+            item = layout;
+
+            return;
+        }
+    }
+
+    queue.push_back(layout);
+    queueCondition.notify_one();
+}
+
+/**
+ * Get the finished layouts.
+ *
+ * Note: endSwap() has to be called after the layouts were applied.
+ */
+void AminoLayoutPool::beginSwap(std::vector<amino_text_layout_t *> &res) {
+    swapLock.lock();
+
+    std::lock_guard<std::mutex> guard(lock);
+
+    res.swap(done);
+}
+
+/**
+ * Finished layouts were applied.
+ */
+void AminoLayoutPool::endSwap() {
+    swapLock.unlock();
+}
+
+/**
+ * Drop all layouts of a text.
+ *
+ * Note: called before the text is destroyed.
+ */
+void AminoLayoutPool::cancel(AminoText *text) {
+    std::lock_guard<std::mutex> swapGuard(swapLock);
+    std::lock_guard<std::mutex> guard(lock);
+
+    //queued
+    for (auto it = queue.begin(); it != queue.end();) {
+        if ((*it)->text == text) {
+            delete *it;
+            it = queue.erase(it);
+        } else {
+            it++;
+        }
+    }
+
+    //in progress (dropped when done)
+    for (auto const &layout : active) {
+        if (layout->text == text) {
+            layout->text = NULL;
+        }
+    }
+
+    //finished
+    for (auto it = done.begin(); it != done.end();) {
+        if ((*it)->text == text) {
+            delete *it;
+            it = done.erase(it);
+        } else {
+            it++;
+        }
+    }
+}
+
+/**
+ * Worker thread.
+ */
+void AminoLayoutPool::workerThread(void *arg) {
+    AminoLayoutPool *pool = static_cast<AminoLayoutPool *>(arg);
+
+    assert(pool);
+
+    pool->work();
+}
+
+/**
+ * Lay out queued texts until the pool is stopped.
+ */
+void AminoLayoutPool::work() {
+    while (true) {
+        amino_text_layout_t *layout;
+
+        //next job
+        {
+            std::unique_lock<std::mutex> guard(lock);
+
+            queueCondition.wait(guard, [this] {
+                return !running || !queue.empty();
+            });
+
+            if (!running) {
+                break;
+            }
+
+            layout = queue.front();
+            queue.pop_front();
+            active.push_back(layout);
+        }
+
+        //Note: only the font of the text is locked
+        AminoText::runLayout(layout);
+
+        //result
+        bool cancelled;
+
+        {
+            std::lock_guard<std::mutex> guard(lock);
+
+            active.erase(std::find(active.begin(), active.end(), layout));
+            cancelled = layout->text == NULL;
+
+            if (cancelled) {
+                delete layout;
+            } else {
+                done.push_back(layout);
+            }
+        }
+
+        //render the new vertices
+        if (!cancelled) {
+            gfx->invalidateScene();
+        }
+    }
+}
@@ -0,0 +1,158 @@
+#ifndef _AMINO_LAYOUT_H
+#define _AMINO_LAYOUT_H
+
+#include "gfx.h"
+#include "fonts.h"
+
+#include <uv.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include <condition_variable>
+
+class AminoGfx;
+class AminoText;
+
+/**
+ * Text layout (input values and resulting glyph vertices).
+ */
+struct amino_text_layout_t {
+    //input (copied on rendering thread)
+    AminoText *text = NULL; //NULL if cancelled
+    uint32_t generation = 0;
+    AminoFont *font = NULL;
+    texture_font_t *fontTexture = NULL;
+    float scale = 1;
+    bool sdf = false;
+    std::string str;
+    int wrap = 0;
+    float width = 0;
+    int32_t maxLines = 0;
+
+    //result
+    vertex_buffer_t *buffer = NULL;
+    std::vector<amino_text_page_t> pages;
+    std::vector<uint16_t> glyphPages; //page index of each glyph in buffer
+    GLfloat bounds[4] = { 0, 0, 0, 0 };
+    int lineNr = 1;
+    float lineW = 0;
+    bool glyphsChanged = false;
+
+    ~amino_text_layout_t() {
+        if (buffer) {
+            vertex_buffer_delete(buffer);
+        }
+    }
+};
+
+/**
+ * Layout cache key (text, font size and wrap parameters).
+ */
+struct amino_layout_key_t {
+    texture_font_t *fontTexture;
+    float scale;
+    int wrap;
+    float width;
+    int32_t maxLines;
+    std::string str;
+
+    bool operator==(const amino_layout_key_t &other) const;
+};
+
+struct amino_layout_key_hash_t {
+    std::size_t operator()(const amino_layout_key_t &key) const;
+};
+
+/**
+ * Cached layout (glyph quads and line metrics).
+ */
+struct amino_layout_entry_t {
+    amino_layout_key_t key;
+    AminoFont *font;
+
+    //vertex buffer data
+    std::vector<uint8_t> vertices;
+    std::vector<uint8_t> indices;
+    std::vector<uint8_t> items;
+
+    std::vector<amino_text_page_t> pages;
+    std::vector<uint16_t> glyphPages;
+    GLfloat bounds[4];
+    int lineNr;
+    float lineW;
+};
+
+/**
+ * Bounded cache of text layouts (least recently used entries are dropped).
+ *
+ * Shared by all texts; entries with evicted atlas pages are invalid.
+ */
+class AminoLayoutCache {
+public:
+    AminoLayoutCache();
+    ~AminoLayoutCache();
+
+    bool get(amino_text_layout_t *layout);
+    void put(amino_text_layout_t *layout);
+    void removeFont(AminoFont *font);
+
+    void getStats(v8::Local<v8::Object> &obj);
+
+private:
+    std::mutex lock;
+    std::list<amino_layout_entry_t *> entries; //most recently used first
+    std::unordered_map<amino_layout_key_t, std::list<amino_layout_entry_t *>::iterator, amino_layout_key_hash_t> index;
+
+    uint32_t hits = 0;
+    uint32_t misses = 0;
+
+    static bool isCacheable(amino_text_layout_t *layout);
+    static void initKey(amino_layout_key_t &key, amino_text_layout_t *layout);
+    void removeEntry(std::list<amino_layout_entry_t *>::iterator it);
+};
+
+/**
+ * Worker threads rasterizing glyphs and laying out texts.
+ *
+ * Layouts are queued on the rendering thread, which swaps in the finished ones before rendering.
+ */
+class AminoLayoutPool {
+public:
+    AminoLayoutPool();
+    ~AminoLayoutPool();
+
+    //main thread
+    void start(AminoGfx *gfx, uint32_t threadCount);
+    void stop();
+    void cancel(AminoText *text);
+
+    //rendering thread
+    bool isRunning();
+    void add(amino_text_layout_t *layout);
+    void beginSwap(std::vector<amino_text_layout_t *> &done);
+    void endSwap();
+
+private:
+    AminoGfx *gfx = NULL;
+    std::vector<uv_thread_t> threads;
+    bool running = false;
+
+    //jobs
+    std::mutex lock;
+    std::condition_variable queueCondition;
+    std::deque<amino_text_layout_t *> queue;
+    std::vector<amino_text_layout_t *> active;
+    std::vector<amino_text_layout_t *> done;
+
+    //held while finished layouts are swapped in (texts must not be destroyed)
+    std::mutex swapLock;
+
+    static void workerThread(void *arg);
+    void work();
+};
+
+#endif
@@ -3,13 +3,33 @@
 #define M_PI 3.14159
 #endif
 
+/*
+ * SIMD kernels (compile-time dispatch).
+ *
+ *  - NEON: aarch64 and armv7 builds with -mfpu=neon*
+ *  - SSE: x86 (always available on x86_64)
+ *  - scalar fallback otherwise
+ */
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define MATH_NEON
+#include <arm_neon.h>
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define MATH_SSE
+#include <xmmintrin.h>
+#endif
+
+static const GLfloat IDENTITY_MATRIX[16] = {
+    1.f, 0.f, 0.f, 0.f,
+    0.f, 1.f, 0.f, 0.f,
+    0.f, 0.f, 1.f, 0.f,
+    0.f, 0.f, 0.f, 1.f
+};
+
 /**
  * Reset 4x4 matrix with zero values.
  */
 void clear_matrix(GLfloat *m) {
-    for (int i = 0; i < 16; i++) {
-        m[i] = 0.0f;
-    }
+    memset(m, 0, sizeof(GLfloat) * 16);
 }
 
 /**
@@ -22,13 +42,8 @@ void make_y_rot_matrix(GLfloat angle, GLfloat *m) {
     float c = cos(rad);
     float s = sin(rad);
 
-    //reset
-    for (int i = 0; i < 16; i++) {
-        m[i] = 0.0f;
-    }
-
-    //identity values
-    m[0] = m[5] = m[10] = m[15] = 1.0f;
+    //identity
+    make_identity_matrix(m);
 
     //rotation values
     m[0]  = c;
@@ -47,13 +62,8 @@ void make_z_rot_matrix(GLfloat angle, GLfloat *m) {
     float c = cos(rad);
     float s = sin(rad);
 
-    //reset
-    for (int i = 0; i < 16; i++) {
-        m[i] = 0.0f;
-    }
-
-    //identity values
-    m[0] = m[5] = m[10] = m[15] = 1.0f;
+    //identity
+    make_identity_matrix(m);
 
     //rotation values
     m[0] = c;
@@ -72,13 +82,8 @@ void make_x_rot_matrix(GLfloat angle, GLfloat *m) {
     float c = cos(rad);
     float s = sin(rad);
 
-    //reset
-    for (int i = 0; i < 16; i++) {
-        m[i] = 0.0f;
-    }
-
-    //identity values
-    m[0] = m[5] = m[10] = m[15] = 1.0f;
+    //identity
+    make_identity_matrix(m);
 
     //rotation values
     m[5]  = c;
@@ -116,16 +121,7 @@ void print_matrix(GLfloat *m) {
  * Create identity matrix.
  */
 void make_identity_matrix(GLfloat *m) {
-   //reset
-   for (int i = 0; i < 16; i++) {
-      m[i] = 0.0;
-   }
-
-   //diagonal elements
-   m[0] = 1.f;
-   m[5] = 1.f;
-   m[10] = 1.f;
-   m[15] = 1.f;
+    memcpy(m, IDENTITY_MATRIX, sizeof IDENTITY_MATRIX);
 }
 
 /**
@@ -338,12 +334,94 @@ bool make_square_to_quad_matrix(GLfloat dx0, GLfloat dy0, GLfloat dx1, GLfloat d
 	return true;
 }
 
+#if defined(MATH_NEON)
+/**
+ * Multiply matrix a (columns) with column vector b.
+ */
+static inline float32x4_t mul_matrix_column(float32x4_t a0, float32x4_t a1, float32x4_t a2, float32x4_t a3, float32x4_t b) {
+#if defined(__aarch64__)
+    float32x4_t p = vmulq_laneq_f32(a0, b, 0);
+
+    p = vfmaq_laneq_f32(p, a1, b, 1);
+    p = vfmaq_laneq_f32(p, a2, b, 2);
+    p = vfmaq_laneq_f32(p, a3, b, 3);
+#else
+    float32x2_t lo = vget_low_f32(b);
+    float32x2_t hi = vget_high_f32(b);
+    float32x4_t p = vmulq_lane_f32(a0, lo, 0);
+
+    p = vmlaq_lane_f32(p, a1, lo, 1);
+    p = vmlaq_lane_f32(p, a2, hi, 0);
+    p = vmlaq_lane_f32(p, a3, hi, 1);
+#endif
+
+    return p;
+}
+#elif defined(MATH_SSE)
+/**
+ * Multiply matrix a (columns) with column vector b.
+ */
+static inline __m128 mul_matrix_column(__m128 a0, __m128 a1, __m128 a2, __m128 a3, __m128 b) {
+    return _mm_add_ps(
+        _mm_add_ps(_mm_mul_ps(a0, _mm_shuffle_ps(b, b, 0x00)), _mm_mul_ps(a1, _mm_shuffle_ps(b, b, 0x55))),
+        _mm_add_ps(_mm_mul_ps(a2, _mm_shuffle_ps(b, b, 0xaa)), _mm_mul_ps(a3, _mm_shuffle_ps(b, b, 0xff)))
+    );
+}
+#endif
+
 /**
  * Matrix multiplication (4x4).
  *
+ * Note: prod may be a or b.
+ *
  * @param prod result
  */
 void mul_matrix(GLfloat *prod, const GLfloat *a, const GLfloat *b) {
+#if defined(MATH_NEON)
+    //columns of a
+    float32x4_t a0 = vld1q_f32(a);
+    float32x4_t a1 = vld1q_f32(a + 4);
+    float32x4_t a2 = vld1q_f32(a + 8);
+    float32x4_t a3 = vld1q_f32(a + 12);
+
+    //columns of b
+    float32x4_t b0 = vld1q_f32(b);
+    float32x4_t b1 = vld1q_f32(b + 4);
+    float32x4_t b2 = vld1q_f32(b + 8);
+    float32x4_t b3 = vld1q_f32(b + 12);
+
+    vst1q_f32(prod, mul_matrix_column(a0, a1, a2, a3, b0));
+    vst1q_f32(prod + 4, mul_matrix_column(a0, a1, a2, a3, b1));
+    vst1q_f32(prod + 8, mul_matrix_column(a0, a1, a2, a3, b2));
+    vst1q_f32(prod + 12, mul_matrix_column(a0, a1, a2, a3, b3));
+#elif defined(MATH_SSE)
+    //columns of a
+    __m128 a0 = _mm_loadu_ps(a);
+    __m128 a1 = _mm_loadu_ps(a + 4);
+    __m128 a2 = _mm_loadu_ps(a + 8);
+    __m128 a3 = _mm_loadu_ps(a + 12);
+
+    //columns of b
+    __m128 b0 = _mm_loadu_ps(b);
+    __m128 b1 = _mm_loadu_ps(b + 4);
+    __m128 b2 = _mm_loadu_ps(b + 8);
+    __m128 b3 = _mm_loadu_ps(b + 12);
+
+    _mm_storeu_ps(prod, mul_matrix_column(a0, a1, a2, a3, b0));
+    _mm_storeu_ps(prod + 4, mul_matrix_column(a0, a1, a2, a3, b1));
+    _mm_storeu_ps(prod + 8, mul_matrix_column(a0, a1, a2, a3, b2));
+    _mm_storeu_ps(prod + 12, mul_matrix_column(a0, a1, a2, a3, b3));
+#else
+    mul_matrix_scalar(prod, a, b);
+#endif
+}
+
+/**
+ * Matrix multiplication (4x4, scalar version).
+ *
+ * @param prod result
+ */
+void mul_matrix_scalar(GLfloat *prod, const GLfloat *a, const GLfloat *b) {
 #define A(row,col)  a[(col<<2)+row]
 #define B(row,col)  b[(col<<2)+row]
 #define P(row,col)  p[(col<<2)+row]
@@ -362,7 +440,60 @@ void mul_matrix(GLfloat *prod, const GLfloat *a, const GLfloat *b) {
    memcpy(prod, p, sizeof p);
 #undef A
 #undef B
-#undef PROD
+#undef P
+}
+
+/**
+ * Get the name of the active matrix kernels.
+ */
+const char* get_matrix_kernel_name() {
+#if defined(MATH_NEON)
+    return "neon";
+#elif defined(MATH_SSE)
+    return "sse";
+#else
+    return "scalar";
+#endif
+}
+
+/**
+ * Multiply with translation matrix (in place).
+ *
+ * Note: only the last column changes.
+ */
+void mul_trans_matrix(GLfloat *m, GLfloat x, GLfloat y, GLfloat z) {
+#if defined(MATH_NEON)
+    float32x4_t c3 = vld1q_f32(m + 12);
+
+    c3 = vmlaq_n_f32(c3, vld1q_f32(m), x);
+    c3 = vmlaq_n_f32(c3, vld1q_f32(m + 4), y);
+    c3 = vmlaq_n_f32(c3, vld1q_f32(m + 8), z);
+
+    vst1q_f32(m + 12, c3);
+#elif defined(MATH_SSE)
+    __m128 c3 = _mm_loadu_ps(m + 12);
+
+    c3 = _mm_add_ps(c3, _mm_mul_ps(_mm_loadu_ps(m), _mm_set1_ps(x)));
+    c3 = _mm_add_ps(c3, _mm_mul_ps(_mm_loadu_ps(m + 4), _mm_set1_ps(y)));
+    c3 = _mm_add_ps(c3, _mm_mul_ps(_mm_loadu_ps(m + 8), _mm_set1_ps(z)));
+
+    _mm_storeu_ps(m + 12, c3);
+#else
+    for (int i = 0; i < 4; i++) {
+        m[12 + i] += m[i] * x + m[4 + i] * y + m[8 + i] * z;
+    }
+#endif
+}
+
+/**
+ * Multiply with scale matrix (in place).
+ */
+void mul_scale_matrix(GLfloat *m, GLfloat x, GLfloat y, GLfloat z) {
+    for (int i = 0; i < 4; i++) {
+        m[i] *= x;
+        m[4 + i] *= y;
+        m[8 + i] *= z;
+    }
 }
 
 /**
@@ -403,9 +534,7 @@ void loadOrthoMatrix(GLfloat *modelView, GLfloat left, GLfloat right, GLfloat bo
  * Copy a matrix.
  */
 void copy_matrix(GLfloat *dst, const GLfloat *src) {
-    for (int i = 0; i < 16; i++) {
-        dst[i] = src[i];
-    }
+    memcpy(dst, src, sizeof(GLfloat) * 16);
 }
 
 /**
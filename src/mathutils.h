@@ -34,6 +34,10 @@ bool make_quad_to_square_matrix(GLfloat sx0, GLfloat sy0, GLfloat sx1, GLfloat s
 bool make_square_to_quad_matrix(GLfloat dx0, GLfloat dy0, GLfloat dx1, GLfloat dy1, GLfloat dx2, GLfloat dy2, GLfloat dx3, GLfloat dy3, GLfloat *matrix);
 
 void mul_matrix(GLfloat *prod, const GLfloat *a, const GLfloat *b);
+void mul_matrix_scalar(GLfloat *prod, const GLfloat *a, const GLfloat *b);
+const char* get_matrix_kernel_name();
+void mul_trans_matrix(GLfloat *m, GLfloat x, GLfloat y, GLfloat z);
+void mul_scale_matrix(GLfloat *m, GLfloat x, GLfloat y, GLfloat z);
 
 void loadOrthoMatrix(GLfloat *modelView, GLfloat left, GLfloat right, GLfloat bottom, GLfloat top, GLfloat near, GLfloat far);
 
@@ -1,9 +1,19 @@
 #include "renderer.h"
 
+#include <algorithm>
+#include <cmath>
+
 #define DEBUG_RENDERER false
 #define DEBUG_RENDERER_ERRORS false
 #define DEBUG_FONT_PERFORMANCE 0
 
+//combine rects, images and text into batched draw calls
+#define USE_QUAD_BATCH true
+#define MAX_BATCH_QUADS 2048
+
+//skip off-screen nodes (orthographic projection only)
+#define USE_CULLING true
+
 #define r_assert(x) _r_assert((void*)((x)), __LINE__)
 
 void _r_assert(void* x, int line) {
@@ -58,6 +68,12 @@ AminoRenderer::~AminoRenderer () {
         fontShader = NULL;
     }
 
+    if (sdfFontShader) {
+        sdfFontShader->destroy();
+        delete sdfFontShader;
+        sdfFontShader = NULL;
+    }
+
     //color lighting shader
     if (colorLightingShader) {
         colorLightingShader->destroy();
@@ -72,6 +88,26 @@ AminoRenderer::~AminoRenderer () {
         textureLightingShader = NULL;
     }
 
+    //batch shaders
+    for (int i = 0; i < 3; i++) {
+        if (batchShaders[i]) {
+            batchShaders[i]->destroy();
+            delete batchShaders[i];
+            batchShaders[i] = NULL;
+        }
+    }
+
+    //batch buffers
+    if (batchVBO != INVALID_BUFFER) {
+        glDeleteBuffers(1, &batchVBO);
+        batchVBO = INVALID_BUFFER;
+    }
+
+    if (batchIBO != INVALID_BUFFER) {
+        glDeleteBuffers(1, &batchIBO);
+        batchIBO = INVALID_BUFFER;
+    }
+
     //context
     if (ctx) {
         delete ctx;
@@ -111,6 +147,9 @@ void AminoRenderer::setup() {
 
     //context
     ctx = new GLContext();
+
+    //quad batch
+    batchVertices.reserve(MAX_BATCH_QUADS * 4);
 }
 
 /**
@@ -323,6 +362,14 @@ void AminoRenderer::updateViewport(GLfloat width, GLfloat height, GLfloat viewpo
         modelView[9] += 2.0f * (vpY - .5f);
     }
 
+    //culling & scissor (screen coordinates are only known in the affine case)
+    sceneW = width;
+    sceneH = height;
+    this->viewportW = viewportW;
+    this->viewportH = viewportH;
+    screenAligned = orthographic && !corrUsed;
+    cullingEnabled = USE_CULLING && screenAligned;
+
     //set viewport
     glViewport(0, 0, viewportW, viewportH);
 }
@@ -351,8 +398,40 @@ void AminoRenderer::renderScene(AminoNode *node) {
         printf("-> renderScene()\n");
     }
 
+    drawCalls = 0;
+    batchedQuads = 0;
+    culledNodes = 0;
+
+    //clip region (scene coordinates)
+    clipBounds[0] = 0;
+    clipBounds[1] = 0;
+    clipBounds[2] = sceneW;
+    clipBounds[3] = sceneH;
+
+    //hit testing (needs 2D screen coordinates)
+    AminoHitIndex *hitIndex = gfx->getHitIndex();
+    bool hitIndexEnabled = hitIndex->isEnabled();
+
+    recordHits = hitIndexEnabled && screenAligned;
+    hitClip = -1;
+
+    if (recordHits) {
+        hitIndex->begin(sceneW, sceneH);
+    }
+
     render(node);
 
+    //draw remaining quads
+    flushBatch();
+
+    if (hitIndexEnabled) {
+        hitIndex->publish(recordHits);
+    }
+
+    lastDrawCalls = drawCalls;
+    lastBatchedQuads = batchedQuads;
+    lastCulledNodes = culledNodes;
+
     ctx->reset();
 }
 
@@ -377,40 +456,72 @@ void AminoRenderer::render(AminoNode *root) {
     ctx->save();
 
     //transform
-    // if (root->propW) {
-    //     //apply origin
-    //     ctx->translate(root->propW->value * root->propOriginX->value, root->propH->value * root->propOriginY->value);
-    // }
+    applyTransform(root);
+
+    //skip nodes outside of the viewport or clip region
+    if (cullingEnabled && isCulled(root)) {
+        culledNodes++;
+        ctx->restore();
+
+        return;
+    }
 
-    ctx->translate(root->propX->value, root->propY->value, root->propZ->value);
-    ctx->scale(root->propScaleX->value, root->propScaleY->value);
-    ctx->rotate(root->propRotateX->value, root->propRotateY->value, root->propRotateZ->value);
+    //hit testing
+    int32_t hitEntry = -1;
 
-    if (root->propW) {
-        //apply origin
-        ctx->translate(- (root->propW->value* root->propOriginX->value), - (root->propH->value * root->propOriginY->value));
+    if (recordHits) {
+        hitEntry = addHitEntry(root);
     }
 
     //draw
     switch (root->type) {
         case GROUP:
-            this->drawGroup(static_cast<AminoGroup *>(root));
+            {
+                TRACE_SCOPE("drawGroup");
+
+                AminoGroup *group = static_cast<AminoGroup *>(root);
+                int32_t prevHitClip = hitClip;
+
+                if (hitEntry >= 0 && group->propClipRect->value) {
+                    hitClip = hitEntry;
+                }
+
+                this->drawGroup(group);
+
+                hitClip = prevHitClip;
+            }
             break;
 
         case RECT:
-            this->drawRect(static_cast<AminoRect *>(root));
+            {
+                TRACE_SCOPE("drawRect");
+
+                this->drawRect(static_cast<AminoRect *>(root));
+            }
             break;
 
         case POLY:
-            this->drawPoly(static_cast<AminoPolygon *>(root));
+            {
+                TRACE_SCOPE("drawPoly");
+
+                this->drawPoly(static_cast<AminoPolygon *>(root));
+            }
             break;
 
         case MODEL:
-            this->drawModel(static_cast<AminoModel *>(root));
+            {
+                TRACE_SCOPE("drawModel");
+
+                this->drawModel(static_cast<AminoModel *>(root));
+            }
             break;
 
         case TEXT:
-            this->drawText(static_cast<AminoText *>(root));
+            {
+                TRACE_SCOPE("drawText");
+
+                this->drawText(static_cast<AminoText *>(root));
+            }
             break;
 
         default:
@@ -427,10 +538,246 @@ void AminoRenderer::render(AminoNode *root) {
     ctx->restore();
 }
 
+/**
+ * Apply the local transformation of a node.
+ *
+ * The local matrix is cached in the node and only rebuilt if position, scale, rotation or origin changed.
+ */
+void AminoRenderer::applyTransform(AminoNode *node) {
+    GLfloat params[10] = {
+        //translate
+        node->propX->value, node->propY->value, node->propZ->value,
+
+        //scale
+        node->propScaleX->value, node->propScaleY->value,
+
+        //rotate
+        node->propRotateX->value, node->propRotateY->value, node->propRotateZ->value,
+
+        //origin
+        0, 0
+    };
+
+    if (node->propW) {
+        params[8] = node->propW->value * node->propOriginX->value;
+        params[9] = node->propH->value * node->propOriginY->value;
+    }
+
+    //check cache
+    bool changed = !node->localMatrixValid;
+
+    if (!changed) {
+        for (int i = 0; i < 10; i++) {
+            if (params[i] != node->localParams[i]) {
+                changed = true;
+                break;
+            }
+        }
+    }
+
+    if (changed) {
+        for (int i = 0; i < 10; i++) {
+            node->localParams[i] = params[i];
+        }
+
+        node->localTranslateOnly = params[3] == 1 && params[4] == 1 && params[5] == 0 && params[6] == 0 && params[7] == 0;
+        node->localMatrixValid = true;
+
+        if (!node->localTranslateOnly) {
+            //order: translate, scale, rotate, origin
+            GLfloat *m = node->localMatrix;
+            GLfloat rot[16];
+
+            make_trans_matrix(params[0], params[1], params[2], m);
+            mul_scale_matrix(m, params[3], params[4], 1);
+
+            if (params[5] != 0) {
+                make_x_rot_matrix(params[5], rot);
+                mul_matrix(m, m, rot);
+            }
+
+            if (params[6] != 0) {
+                make_y_rot_matrix(params[6], rot);
+                mul_matrix(m, m, rot);
+            }
+
+            if (params[7] != 0) {
+                make_z_rot_matrix(params[7], rot);
+                mul_matrix(m, m, rot);
+            }
+
+            mul_trans_matrix(m, - params[8], - params[9], 0);
+        }
+    }
+
+    //apply
+    if (node->localTranslateOnly) {
+        //fast path
+        ctx->translate(params[0] - params[8], params[1] - params[9], params[2]);
+    } else {
+        ctx->multiply(node->localMatrix);
+    }
+}
+
+/**
+ * Get the screen bounds of a local rectangle.
+ *
+ * Note: conservative bounding box, z values are ignored (orthographic projection).
+ */
+void AminoRenderer::getScreenBounds(GLfloat x1, GLfloat y1, GLfloat x2, GLfloat y2, GLfloat bounds[4]) {
+    GLfloat *m = ctx->globaltx;
+    GLfloat xs[4] = { x1, x2, x2, x1 };
+    GLfloat ys[4] = { y1, y1, y2, y2 };
+
+    for (int i = 0; i < 4; i++) {
+        GLfloat x = m[0] * xs[i] + m[4] * ys[i] + m[12];
+        GLfloat y = m[1] * xs[i] + m[5] * ys[i] + m[13];
+
+        if (i == 0 || x < bounds[0]) {
+            bounds[0] = x;
+        }
+
+        if (i == 0 || x > bounds[2]) {
+            bounds[2] = x;
+        }
+
+        if (i == 0 || y < bounds[1]) {
+            bounds[1] = y;
+        }
+
+        if (i == 0 || y > bounds[3]) {
+            bounds[3] = y;
+        }
+    }
+}
+
+/**
+ * Check if a local rectangle touches the current clip region.
+ */
+bool AminoRenderer::isVisible(GLfloat x1, GLfloat y1, GLfloat x2, GLfloat y2) {
+    GLfloat bounds[4];
+
+    getScreenBounds(x1, y1, x2, y2, bounds);
+
+    return !(bounds[2] < clipBounds[0] || bounds[0] > clipBounds[2] || bounds[3] < clipBounds[1] || bounds[1] > clipBounds[3]);
+}
+
+/**
+ * Get the local bounds of a node.
+ *
+ * Returns false if the node has no known extent (text and models).
+ */
+bool AminoRenderer::getLocalBounds(AminoNode *node, GLfloat bounds[4]) {
+    switch (node->type) {
+        case RECT:
+        case GROUP:
+            bounds[0] = 0;
+            bounds[1] = 0;
+            bounds[2] = node->propW->value;
+            bounds[3] = node->propH->value;
+
+            return true;
+
+        case POLY:
+            {
+                AminoPolygon *poly = static_cast<AminoPolygon *>(node);
+                std::size_t len = poly->propGeometry->getSize();
+                int dim = poly->propDimension->value;
+
+                if (len < (std::size_t)dim || dim < 2) {
+                    return false;
+                }
+
+                //bounding box
+                GLfloat *verts = poly->propGeometry->getData();
+                GLfloat minX = verts[0];
+                GLfloat maxX = verts[0];
+                GLfloat minY = verts[1];
+                GLfloat maxY = verts[1];
+
+                for (std::size_t i = dim; i + 1 < len; i += dim) {
+                    GLfloat x = verts[i];
+                    GLfloat y = verts[i + 1];
+
+                    if (x < minX) {
+                        minX = x;
+                    } else if (x > maxX) {
+                        maxX = x;
+                    }
+
+                    if (y < minY) {
+                        minY = y;
+                    } else if (y > maxY) {
+                        maxY = y;
+                    }
+                }
+
+                bounds[0] = minX;
+                bounds[1] = minY;
+                bounds[2] = maxX;
+                bounds[3] = maxY;
+
+                return true;
+            }
+
+        default:
+            return false;
+    }
+}
+
+/**
+ * Check if a node (and its children) can be skipped.
+ *
+ * Note: text is checked in drawText(), models are never culled.
+ */
+bool AminoRenderer::isCulled(AminoNode *node) {
+    //children may be anywhere
+    if (node->type == GROUP && !static_cast<AminoGroup *>(node)->propClipRect->value) {
+        return false;
+    }
+
+    GLfloat bounds[4];
+
+    if (!getLocalBounds(node, bounds)) {
+        return false;
+    }
+
+    return !isVisible(bounds[0], bounds[1], bounds[2], bounds[3]);
+}
+
+/**
+ * Add a drawn node to the hit test index.
+ *
+ * Returns the entry index or -1 if the node cannot be hit.
+ */
+int32_t AminoRenderer::addHitEntry(AminoNode *node) {
+    GLfloat local[4];
+
+    if (!getLocalBounds(node, local)) {
+        return -1;
+    }
+
+    //visible part
+    GLfloat screen[4];
+
+    getScreenBounds(local[0], local[1], local[2], local[3], screen);
+
+    screen[0] = std::max(screen[0], clipBounds[0]);
+    screen[1] = std::max(screen[1], clipBounds[1]);
+    screen[2] = std::min(screen[2], clipBounds[2]);
+    screen[3] = std::min(screen[3], clipBounds[3]);
+
+    return gfx->getHitIndex()->add(node, ctx->globaltx, local, screen, hitClip);
+}
+
 /**
  * Use solid color shader.
  */
 void AminoRenderer::applyColorShader(GLfloat *verts, GLsizei dim, GLsizei count, GLfloat color[4], GLenum mode) {
+    //keep painter's order
+    flushBatch();
+    drawCalls++;
+
     //use shader
     ctx->useShader(colorShader);
 
@@ -468,6 +815,10 @@ void AminoRenderer::applyColorShader(GLfloat *verts, GLsizei dim, GLsizei count,
 void AminoRenderer::applyTextureShader(GLfloat *verts, GLsizei dim, GLsizei count, GLfloat uv[][2], GLuint texId, GLfloat opacity, bool needsClampToBorder, bool repeatX, bool repeatY) {
     //printf("doing texture shader apply %d opacity = %f\n", texId, opacity);
 
+    //keep painter's order
+    flushBatch();
+    drawCalls++;
+
     //use shader
     TextureShader *shader;
 
@@ -521,6 +872,12 @@ void AminoRenderer::drawGroup(AminoGroup *group) {
     }
 
     bool useDepth = group->propDepth->value;
+    bool useClipping = group->propClipRect->value;
+
+    //draw pending quads before changing depth or stencil state
+    if (useDepth || useClipping) {
+        flushBatch();
+    }
 
     if (useDepth) {
         //enable depth mask
@@ -530,54 +887,54 @@ void AminoRenderer::drawGroup(AminoGroup *group) {
     /*
      * Clipping:
      *
-     *  - quite slow on Raspberry Pi!
+     *  - scissor test if the group is axis-aligned on screen
+     *  - stencil otherwise (quite slow on Raspberry Pi!)
      */
-    bool useClipping = group->propClipRect->value;
+    bool useScissor = false;
+    bool prevScissorEnabled = scissorEnabled;
+    GLint prevScissorBox[4];
 
     if (useClipping) {
-        //turn on stenciling
-        glEnable(GL_STENCIL_TEST);
+        GLfloat *m = ctx->globaltx;
 
-        //setup the stencil
-        glStencilFunc(GL_ALWAYS, 0x1, 0xFF);
-        glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
-        glStencilMask(0xFF);
-        glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+        useScissor = screenAligned && m[1] == 0 && m[4] == 0;
 
-        //clear the buffers
-        glClear(GL_STENCIL_BUFFER_BIT);
+        if (useScissor) {
+            for (int i = 0; i < 4; i++) {
+                prevScissorBox[i] = scissorBox[i];
+            }
 
-        //draw the stencil
-        float x = 0;
-        float y = 0;
-        float x2 = group->propW->value;
-        float y2 = group->propH->value;
-        GLfloat verts[6][2];
+            applyScissor(group->propW->value, group->propH->value);
+        } else {
+            //nested stencil (increment inside parent region)
+            if (stencilDepth == 0) {
+                glEnable(GL_STENCIL_TEST);
+                glStencilMask(0xFF);
+                glClearStencil(0);
+                glClear(GL_STENCIL_BUFFER_BIT);
+            }
 
-        verts[0][0] = x;
-        verts[0][1] = y;
-        verts[1][0] = x2;
-        verts[1][1] = y;
-        verts[2][0] = x2;
-        verts[2][1] = y2;
+            drawClipStencil(group, GL_INCR);
+            stencilDepth++;
+        }
+    }
 
-        verts[3][0] = x2;
-        verts[3][1] = y2;
-        verts[4][0] = x;
-        verts[4][1] = y2;
-        verts[5][0] = x;
-        verts[5][1] = y;
+    //limit culling to clip region
+    GLfloat prevClipBounds[4];
 
-        GLfloat color[4] = { 1.0, 1.0, 1.0, 1.0 };
+    if (useClipping && cullingEnabled) {
+        GLfloat bounds[4];
 
-        applyColorShader((float *)verts, 2, 6, color);
+        getScreenBounds(0, 0, group->propW->value, group->propH->value, bounds);
 
-        //set function to draw pixels where the buffer is equal to 1
-        glStencilFunc(GL_EQUAL, 0x1, 0xFF);
-        glStencilMask(0x00);
+        for (int i = 0; i < 4; i++) {
+            prevClipBounds[i] = clipBounds[i];
+        }
 
-        //turn color buffer drawing back on
-        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+        clipBounds[0] = std::max(clipBounds[0], bounds[0]);
+        clipBounds[1] = std::max(clipBounds[1], bounds[1]);
+        clipBounds[2] = std::min(clipBounds[2], bounds[2]);
+        clipBounds[3] = std::min(clipBounds[3], bounds[3]);
     }
 
     //group opacity
@@ -594,8 +951,39 @@ void AminoRenderer::drawGroup(AminoGroup *group) {
     //restore opacity
     ctx->restoreOpacity();
 
+    if (useClipping && cullingEnabled) {
+        for (int i = 0; i < 4; i++) {
+            clipBounds[i] = prevClipBounds[i];
+        }
+    }
+
+    if (useDepth || useClipping) {
+        flushBatch();
+    }
+
     if (useClipping) {
-        glDisable(GL_STENCIL_TEST);
+        if (useScissor) {
+            //restore parent scissor
+            scissorEnabled = prevScissorEnabled;
+
+            for (int i = 0; i < 4; i++) {
+                scissorBox[i] = prevScissorBox[i];
+            }
+
+            if (scissorEnabled) {
+                glScissor(scissorBox[0], scissorBox[1], scissorBox[2], scissorBox[3]);
+            } else {
+                glDisable(GL_SCISSOR_TEST);
+            }
+        } else {
+            //remove own region
+            drawClipStencil(group, GL_DECR);
+            stencilDepth--;
+
+            if (stencilDepth == 0) {
+                glDisable(GL_STENCIL_TEST);
+            }
+        }
     }
 
     if (useDepth) {
@@ -604,6 +992,82 @@ void AminoRenderer::drawGroup(AminoGroup *group) {
     }
 }
 
+/**
+ * Limit drawing to the group rectangle (intersected with the parent scissor box).
+ */
+void AminoRenderer::applyScissor(GLfloat w, GLfloat h) {
+    GLfloat bounds[4];
+
+    getScreenBounds(0, 0, w, h, bounds);
+
+    //scene to viewport coordinates (bottom-left origin)
+    GLfloat sx = sceneW > 0 ? viewportW / sceneW:1;
+    GLfloat sy = sceneH > 0 ? viewportH / sceneH:1;
+    GLint x1 = (GLint)roundf(bounds[0] * sx);
+    GLint x2 = (GLint)roundf(bounds[2] * sx);
+    GLint y1 = (GLint)roundf(viewportH - bounds[3] * sy);
+    GLint y2 = (GLint)roundf(viewportH - bounds[1] * sy);
+
+    if (scissorEnabled) {
+        x1 = std::max(x1, scissorBox[0]);
+        y1 = std::max(y1, scissorBox[1]);
+        x2 = std::min(x2, scissorBox[0] + scissorBox[2]);
+        y2 = std::min(y2, scissorBox[1] + scissorBox[3]);
+    } else {
+        glEnable(GL_SCISSOR_TEST);
+        scissorEnabled = true;
+    }
+
+    scissorBox[0] = x1;
+    scissorBox[1] = y1;
+    scissorBox[2] = std::max(x2 - x1, 0);
+    scissorBox[3] = std::max(y2 - y1, 0);
+
+    glScissor(scissorBox[0], scissorBox[1], scissorBox[2], scissorBox[3]);
+}
+
+/**
+ * Update the clip region in the stencil buffer.
+ *
+ * GL_INCR adds the group rectangle inside the current region, GL_DECR removes it again.
+ *
+ * Note: stencilDepth is the stencil value of the current region.
+ */
+void AminoRenderer::drawClipStencil(AminoGroup *group, GLenum op) {
+    //only touch pixels inside the current region
+    glStencilFunc(GL_EQUAL, stencilDepth, 0xFF);
+    glStencilOp(GL_KEEP, op, op);
+    glStencilMask(0xFF);
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    glDepthMask(GL_FALSE);
+
+    //draw the stencil
+    float x = 0;
+    float y = 0;
+    float x2 = group->propW->value;
+    float y2 = group->propH->value;
+    GLfloat verts[6][2] = {
+        { x,  y  }, { x2, y  }, { x2, y2 },
+        { x2, y2 }, { x,  y2 }, { x,  y  }
+    };
+    GLfloat color[4] = { 1.0, 1.0, 1.0, 1.0 };
+
+    applyColorShader((float *)verts, 2, 6, color);
+
+    //draw pixels inside the resulting region
+    GLint depth = op == GL_INCR ? stencilDepth + 1:stencilDepth - 1;
+
+    glStencilFunc(GL_EQUAL, depth, 0xFF);
+    glStencilMask(0x00);
+
+    //turn color buffer drawing back on
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+
+    if (ctx->hasDepth()) {
+        glDepthMask(GL_TRUE);
+    }
+}
+
 /**
  * Draw a polygon.
  */
@@ -612,11 +1076,10 @@ void AminoRenderer::drawPoly(AminoPolygon *poly) {
         printf("-> drawPoly()\n");
     }
 
-    //vertices
-    std::vector<float> *geometry = &poly->propGeometry->value;
-    int len = geometry->size();
+    //vertices (Note: shared with JS)
+    int len = poly->propGeometry->getSize();
     int dim = poly->propDimension->value;
-    GLfloat *verts = geometry->data();
+    GLfloat *verts = poly->propGeometry->getData();
 
     r_assert(dim == 2 || dim == 3);
 
@@ -637,6 +1100,25 @@ void AminoRenderer::drawPoly(AminoPolygon *poly) {
     applyColorShader(verts, dim, len / dim, color, mode);
 }
 
+/**
+ * Upload float array values to the bound VBO.
+ *
+ * Only the changed range is uploaded if the values were modified in place.
+ */
+template<typename T> static void uploadArrayBuffer(T *prop, bool created) {
+    std::size_t start, end;
+
+    if (!created && prop->getChangedRange(start, end)) {
+        if (end > start) {
+            glBufferSubData(GL_ARRAY_BUFFER, sizeof(GLfloat) * start, sizeof(GLfloat) * (end - start), prop->getData() + start);
+        }
+    } else {
+        glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * prop->getSize(), prop->getData(), prop->shared ? GL_DYNAMIC_DRAW:GL_STATIC_DRAW);
+    }
+
+    prop->clearChangedRange();
+}
+
 /**
  * Draw 3D model.
  */
@@ -644,12 +1126,15 @@ void AminoRenderer::drawModel(AminoModel *model) {
     //check rendering mode
 
     // 1) vertices
-    std::vector<float> *vecVertices = &model->propVertices->value;
+    std::size_t vertexCount = model->propVertices->getSize();
 
-    if (vecVertices->empty()) {
+    if (vertexCount == 0) {
         return;
     }
 
+    //keep painter's order
+    flushBatch();
+
     // 2) indices (optional)
     std::vector<ushort> *vecIndices = &model->propIndices->value;
     bool useElements = !vecIndices->empty();
@@ -669,12 +1154,10 @@ void AminoRenderer::drawModel(AminoModel *model) {
     }
 
     // 3) normals (optional)
-    std::vector<float> *vecNormals = &model->propNormals->value;
-    bool useNormals = !vecNormals->empty();
+    bool useNormals = model->propNormals->getSize() > 0;
 
     // 4) texture coordinates (optional)
-    std::vector<float> *vecUVs = &model->propUVs->value;
-    bool useUVs = !vecUVs->empty();
+    bool useUVs = model->propUVs->getSize() > 0;
 
     if (useUVs && !model->propTexture->value) {
         //texture not yet loaded
@@ -691,20 +1174,23 @@ void AminoRenderer::drawModel(AminoModel *model) {
         //use lighting shader
 
         if (!useElements) {
-            r_assert(vecNormals->size() == vecVertices->size());
+            r_assert(model->propNormals->getSize() == vertexCount);
         }
 
         //get normals
+        bool created = false;
+
         if (model->vboNormal == INVALID_BUFFER) {
             glGenBuffers(1, &model->vboNormal);
             model->vboNormalModified = true;
+            created = true;
         }
 
         glBindBuffer(GL_ARRAY_BUFFER, model->vboNormal);
 
         if (model->vboNormalModified) {
             model->vboNormalModified = false;
-            glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * vecNormals->size(), vecNormals->data(), GL_STATIC_DRAW);
+            uploadArrayBuffer(model->propNormals, created);
         }
 
         //get shader
@@ -771,16 +1257,19 @@ void AminoRenderer::drawModel(AminoModel *model) {
     //texture shader
     if (textureShader) {
         //set texture coordinates
+        bool created = false;
+
         if (model->vboUV == INVALID_BUFFER) {
             glGenBuffers(1, &model->vboUV);
             model->vboUVModified = true;
+            created = true;
         }
 
         glBindBuffer(GL_ARRAY_BUFFER, model->vboUV);
 
         if (model->vboUVModified) {
             model->vboUVModified = false;
-            glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * vecUVs->size(), vecUVs->data(), GL_STATIC_DRAW);
+            uploadArrayBuffer(model->propUVs, created);
         }
 
         textureShader->setTextureCoordinates(NULL);
@@ -795,6 +1284,7 @@ void AminoRenderer::drawModel(AminoModel *model) {
         AminoTexture *texture = static_cast<AminoTexture *>(model->propTexture->value);
 
         texture->prepareTexture(ctx);
+        ctx->invalidateTexture();
         ctx->bindTexture(texture->getTexture());
     }
 
@@ -805,16 +1295,19 @@ void AminoRenderer::drawModel(AminoModel *model) {
     }
 
     //vertices
+    bool created = false;
+
     if (model->vboVertex == INVALID_BUFFER) {
         glGenBuffers(1, &model->vboVertex);
         model->vboVertexModified = true;
+        created = true;
     }
 
     glBindBuffer(GL_ARRAY_BUFFER, model->vboVertex);
 
     if (model->vboVertexModified) {
         model->vboVertexModified = false;
-        glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * vecVertices->size(), vecVertices->data(), GL_STATIC_DRAW);
+        uploadArrayBuffer(model->propVertices, created);
     }
 
     shader->setVertexData(3, NULL);
@@ -827,13 +1320,14 @@ void AminoRenderer::drawModel(AminoModel *model) {
 
     //draw
     shader->setTransformation(modelView, ctx->globaltx);
+    drawCalls++;
 
     if (useElements) {
         //special case: VBO elements
         shader->drawElements(NULL, vecIndices->size(), GL_TRIANGLES);
     } else {
         //render vertices (array or VBO)
-        shader->drawTriangles(vecVertices->size() / 3, GL_TRIANGLES);
+        shader->drawTriangles(vertexCount / 3, GL_TRIANGLES);
     }
 
     //cleanup
@@ -860,29 +1354,18 @@ void AminoRenderer::drawRect(AminoRect *rect) {
         printf("-> drawRect() hasImage=%s\n", rect->hasImage ? "true":"false");
     }
 
-    ctx->save();
-
-    //two triangles
+    //quad
     float x =  0;
     float y =  0;
     float x2 = rect->propW->value;
     float y2 = rect->propH->value;
 
-    GLfloat verts[6][2];
-
-    verts[0][0] = x;
-    verts[0][1] = y;
-    verts[1][0] = x2;
-    verts[1][1] = y;
-    verts[2][0] = x2;
-    verts[2][1] = y2;
-
-    verts[3][0] = x2;
-    verts[3][1] = y2;
-    verts[4][0] = x;
-    verts[4][1] = y2;
-    verts[5][0] = x;
-    verts[5][1] = y;
+    GLfloat verts[4][2] = {
+        { x,  y  },
+        { x2, y  },
+        { x2, y2 },
+        { x,  y2 }
+    };
 
     GLfloat opacity = rect->propOpacity->value * ctx->opacity;
 
@@ -897,19 +1380,17 @@ void AminoRenderer::drawRect(AminoRect *rect) {
             //printf("texture: %i\n", texture->textureId);
 
             //image coordinates (fractional world coordinates)
-            GLfloat texCoords[6][2];
             float tx  = rect->propLeft->value;   //0
             float ty2 = rect->propBottom->value; //1
             float tx2 = rect->propRight->value;  //1
             float ty  = rect->propTop->value;    //0
 
-            texCoords[0][0] = tx;    texCoords[0][1] = ty;
-            texCoords[1][0] = tx2;   texCoords[1][1] = ty;
-            texCoords[2][0] = tx2;   texCoords[2][1] = ty2;
-
-            texCoords[3][0] = tx2;   texCoords[3][1] = ty2;
-            texCoords[4][0] = tx;    texCoords[4][1] = ty2;
-            texCoords[5][0] = tx;    texCoords[5][1] = ty;
+            GLfloat texCoords[4][2] = {
+                { tx,  ty  },
+                { tx2, ty  },
+                { tx2, ty2 },
+                { tx,  ty2 }
+            };
 
             //check clamp to border
             bool needsClampToBorder = (tx < 0 || tx > 1) || (tx2 < 0 || tx2 > 1) || (ty < 0 || ty > 1) || (ty2 < 0 || ty2 > 1) || rect->repeatX || rect->repeatY;
@@ -917,17 +1398,49 @@ void AminoRenderer::drawRect(AminoRect *rect) {
             //debug
             //if (needsClampToBorder) printf("needsClampToBorder\n");
 
-            texture->prepareTexture(ctx);
-            applyTextureShader((float *)verts, 2, 6, texCoords, texture->getTexture(), opacity, needsClampToBorder, rect->repeatX, rect->repeatY);
+            //video frames are uploaded with glBindTexture() (draw pending quads first)
+            if (texture->hasVideo()) {
+                flushBatch();
+                texture->prepareTexture(ctx);
+                ctx->invalidateTexture();
+            }
+
+            if (USE_QUAD_BATCH && !needsClampToBorder) {
+                GLfloat color[4] = { 1, 1, 1, opacity };
+
+                addQuad(QuadBatchShader::MODE_TEXTURE, texture->getTexture(), true, verts, texCoords, color);
+            } else {
+                //two triangles
+                GLfloat verts2[6][2];
+                GLfloat texCoords2[6][2];
+                static const int order[6] = { 0, 1, 2, 2, 3, 0 };
+
+                for (int i = 0; i < 6; i++) {
+                    verts2[i][0] = verts[order[i]][0];
+                    verts2[i][1] = verts[order[i]][1];
+                    texCoords2[i][0] = texCoords[order[i]][0];
+                    texCoords2[i][1] = texCoords[order[i]][1];
+                }
+
+                applyTextureShader((float *)verts2, 2, 6, texCoords2, texture->getTexture(), opacity, needsClampToBorder, rect->repeatX, rect->repeatY);
+            }
         }
     } else {
         //color only
         GLfloat color[4] = { rect->propR->value, rect->propG->value, rect->propB->value, opacity };
 
-        applyColorShader((float *)verts, 2, 6, color);
-    }
+        if (USE_QUAD_BATCH) {
+            addQuad(QuadBatchShader::MODE_COLOR, INVALID_TEXTURE, opacity != 1.0, verts, NULL, color);
+        } else {
+            //two triangles
+            GLfloat verts2[6][2] = {
+                { x,  y  }, { x2, y  }, { x2, y2 },
+                { x2, y2 }, { x,  y2 }, { x,  y  }
+            };
 
-    ctx->restore();
+            applyColorShader((float *)verts2, 2, 6, color);
+        }
+    }
 }
 
 /**
@@ -938,10 +1451,8 @@ void AminoRenderer::drawText(AminoText *text) {
         printf("-> drawText()\n");
     }
 
-    //get texture
-    GLuint texture = text->getTextureId();
-
-    if (texture == INVALID_TEXTURE) {
+    //check textures
+    if (text->pages.empty()) {
         return;
     }
 
@@ -951,7 +1462,12 @@ void AminoRenderer::drawText(AminoText *text) {
     ctx->scale(1, -1);
 
     //baseline at top/left
-    texture_font_t *tf = text->fontSize->fontTexture;
+    //Note: font of the swapped in layout
+    texture_font_t *tf = text->layoutFont;
+    float scale = text->layoutScale; //SDF fonts
+    float ascender = tf->ascender * scale;
+    float descender = tf->descender * scale;
+    float lineHeight = tf->height * scale;
 
     //debug
     //sprintf("font: size=%f height=%f ascender=%f descender=%f\n", tf->size, tf->height, tf->ascender, tf->descender);
@@ -974,15 +1490,15 @@ void AminoRenderer::drawText(AminoText *text) {
     //vertical alignment
     switch (text->vAlign) {
         case AminoText::VALIGN_TOP:
-            ctx->translate(0, -tf->ascender);
+            ctx->translate(0, -ascender);
             break;
 
         case AminoText::VALIGN_BOTTOM:
-            ctx->translate(0, - text->propH->value - tf->descender + (text->lineNr - 1) * tf->height);
+            ctx->translate(0, - text->propH->value - descender + (text->lineNr - 1) * lineHeight);
             break;
 
         case AminoText::VALIGN_MIDDLE:
-            ctx->translate(0, - tf->ascender - (text->propH->value - text->lineNr * tf->height) / 2);
+            ctx->translate(0, - ascender - (text->propH->value - text->lineNr * lineHeight) / 2);
             break;
 
         case AminoText::VALIGN_BASELINE:
@@ -995,8 +1511,79 @@ void AminoRenderer::drawText(AminoText *text) {
         showGLErrors("updateTexture()");
     }
 
-    glActiveTexture(GL_TEXTURE0);
-    ctx->bindTexture(texture);
+    //skip text outside of the clip region
+    if (cullingEnabled && !isVisible(text->bounds[0], text->bounds[1], text->bounds[2], text->bounds[3])) {
+        culledNodes++;
+        ctx->restore();
+
+        return;
+    }
+
+    //glyphs evicted from atlas page (skipped until laid out again)
+    if (text->hasEvictedGlyphs()) {
+        gfx->textUpdateNeeded(text);
+        gfx->invalidateScene();
+        ctx->restore();
+
+        return;
+    }
+
+    text->markPagesUsed();
+
+    GLfloat opacity = ctx->opacity * text->propOpacity->value;
+    std::size_t pageCount = text->pages.size();
+
+    //signed distance field
+    if (text->layoutSdf) {
+        drawSdfText(text, opacity);
+        ctx->restore();
+
+        return;
+    }
+
+    if (USE_QUAD_BATCH) {
+        //add glyph quads (4 vertices each), one batch per atlas page
+        GLfloat color[4] = { text->propR->value, text->propG->value, text->propB->value, opacity };
+        vertex_t *vertices = (vertex_t *)text->buffer->vertices->items;
+        std::size_t count = text->buffer->vertices->size;
+
+        for (std::size_t page = 0; page < pageCount; page++) {
+            GLuint texture = text->pages[page].textureId;
+
+            for (std::size_t i = 0; i + 3 < count; i += 4) {
+                vertex_t *v = vertices + i;
+
+                //other page
+                if (text->glyphPages[i / 4] != page) {
+                    continue;
+                }
+
+                //skip hidden glyphs
+                if (v[0].x == v[2].x) {
+                    continue;
+                }
+
+                GLfloat verts[4][2];
+                GLfloat uv[4][2];
+
+                for (int j = 0; j < 4; j++) {
+                    verts[j][0] = v[j].x;
+                    verts[j][1] = v[j].y;
+                    uv[j][0] = v[j].s;
+                    uv[j][1] = v[j].t;
+                }
+
+                addQuad(QuadBatchShader::MODE_ALPHA_TEXTURE, texture, true, verts, uv, color);
+            }
+        }
+
+        ctx->restore();
+
+        return;
+    }
+
+    //keep painter's order
+    flushBatch();
 
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
@@ -1006,7 +1593,7 @@ void AminoRenderer::drawText(AminoText *text) {
 
     //color & opacity
     fontShader->setTransformation(modelView, ctx->globaltx);
-    fontShader->setOpacity(ctx->opacity * text->propOpacity->value);
+    fontShader->setOpacity(opacity);
 
     GLfloat color[3] = { text->propR->value, text->propG->value, text->propB->value };
 
@@ -1016,8 +1603,32 @@ void AminoRenderer::drawText(AminoText *text) {
         showGLErrors("before text rendering");
     }
 
-    //render
-    vertex_buffer_render(text->buffer, GL_TRIANGLES);
+    //render (one draw per atlas page)
+    glActiveTexture(GL_TEXTURE0);
+
+    if (pageCount == 1) {
+        drawCalls++;
+        ctx->bindTexture(text->pages[0].textureId);
+
+        vertex_buffer_render(text->buffer, GL_TRIANGLES);
+    } else {
+        std::size_t count = text->glyphPages.size();
+
+        vertex_buffer_render_setup(text->buffer, GL_TRIANGLES);
+
+        for (std::size_t page = 0; page < pageCount; page++) {
+            drawCalls++;
+            ctx->bindTexture(text->pages[page].textureId);
+
+            for (std::size_t i = 0; i < count; i++) {
+                if (text->glyphPages[i] == page) {
+                    vertex_buffer_render_item(text->buffer, i);
+                }
+            }
+        }
+
+        vertex_buffer_render_finish(text->buffer);
+    }
 
     if (DEBUG_RENDERER_ERRORS) {
         showGLErrors("after text rendering");
@@ -1029,6 +1640,240 @@ void AminoRenderer::drawText(AminoText *text) {
     ctx->restore();
 }
 
+/**
+ * Draw signed distance field text (one draw call per atlas page).
+ */
+void AminoRenderer::drawSdfText(AminoText *text, GLfloat opacity) {
+    //shader
+    if (!sdfFontShader) {
+        sdfFontShader = new AminoFontSdfShader();
+
+        bool res = sdfFontShader->create();
+
+        r_assert(res);
+    }
+
+    //keep painter's order
+    flushBatch();
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    ctx->useShader(sdfFontShader);
+
+    sdfFontShader->setTransformation(modelView, ctx->globaltx);
+    sdfFontShader->setOpacity(opacity);
+
+    GLfloat color[3] = { text->propR->value, text->propG->value, text->propB->value };
+
+    sdfFontShader->setColor(color);
+
+    //distance per pixel (glyph scale and current transformation)
+    GLfloat *m = ctx->globaltx;
+    GLfloat fontScale = text->layoutScale;
+    GLfloat pixelScale = fontScale * std::sqrt(m[0] * m[0] + m[1] * m[1]);
+    GLfloat spread = 2 * TEXTURE_FONT_SDF_SPREAD * fontScale; //distance range in text pixels
+
+    sdfFontShader->setSmoothing(pixelScale > 0 ? std::min(0.25f / (TEXTURE_FONT_SDF_SPREAD * pixelScale), 0.5f):0.5f);
+
+    //outline (limited by spread)
+    GLfloat outlineColor[3] = { text->propOutlineR->value, text->propOutlineG->value, text->propOutlineB->value };
+    GLfloat outlineW = std::min(std::max(text->propOutlineW->value / spread, 0.f), 0.45f);
+
+    sdfFontShader->setOutline(outlineW, outlineColor);
+
+    //shadow (limited by padding)
+    texture_atlas_t *atlas = text->pages[0].page->atlas;
+    GLfloat maxOffset = TEXTURE_FONT_SDF_SPREAD * fontScale;
+    GLfloat shadowOffset[2] = {
+        std::min(std::max(text->propShadowX->value, -maxOffset), maxOffset) / fontScale / atlas->width,
+        std::min(std::max(text->propShadowY->value, -maxOffset), maxOffset) / fontScale / atlas->height
+    };
+    GLfloat shadowSoftness = std::min(std::max(text->propShadowBlur->value / spread, 0.f), 0.45f);
+    GLfloat shadowColor[4] = { text->propShadowR->value, text->propShadowG->value, text->propShadowB->value, text->propShadowOpacity->value };
+
+    sdfFontShader->setShadow(shadowOffset, shadowSoftness, shadowColor);
+
+    //vertices (client memory)
+    vertex_t *vertices = (vertex_t *)text->buffer->vertices->items;
+    GLushort *indices = (GLushort *)text->buffer->indices->items;
+    std::size_t count = text->glyphPages.size();
+
+    sdfFontShader->setGlyphVertexData(sizeof(vertex_t), &vertices->x, &vertices->s);
+
+    for (std::size_t page = 0; page < text->pages.size(); page++) {
+        //collect glyphs (6 indices each)
+        sdfIndices.clear();
+
+        for (std::size_t i = 0; i < count; i++) {
+            if (text->glyphPages[i] != page) {
+                continue;
+            }
+
+            ivec4 *item = (ivec4 *)vector_get(text->buffer->items, i);
+
+            sdfIndices.insert(sdfIndices.end(), indices + item->z, indices + item->z + item->w);
+        }
+
+        if (sdfIndices.empty()) {
+            continue;
+        }
+
+        ctx->bindTexture(text->pages[page].textureId);
+        sdfFontShader->drawElements(sdfIndices.data(), sdfIndices.size(), GL_TRIANGLES);
+        drawCalls++;
+    }
+
+    //cleanup
+    glDisable(GL_BLEND);
+}
+
+/**
+ * Add a quad to the current batch.
+ *
+ * Vertices are transformed on the CPU, the batch gets flushed if the shader, texture or blend state changes.
+ */
+void AminoRenderer::addQuad(int mode, GLuint texId, bool blend, GLfloat verts[4][2], GLfloat uv[4][2], GLfloat color[4]) {
+    //check state
+    if (batchMode != mode || batchTexture != texId || batchBlend != blend || batchVertices.size() >= MAX_BATCH_QUADS * 4) {
+        flushBatch();
+
+        batchMode = mode;
+        batchTexture = texId;
+        batchBlend = blend;
+    }
+
+    //color
+    GLubyte rgba[4];
+
+    for (int i = 0; i < 4; i++) {
+        GLfloat c = color[i];
+
+        if (c < 0) {
+            c = 0;
+        } else if (c > 1) {
+            c = 1;
+        }
+
+        rgba[i] = (GLubyte)(c * 255.f + .5f);
+    }
+
+    //transform (affine)
+    GLfloat *m = ctx->globaltx;
+
+    for (int i = 0; i < 4; i++) {
+        GLfloat x = verts[i][0];
+        GLfloat y = verts[i][1];
+        amino_batch_vertex_t v;
+
+        v.x = m[0] * x + m[4] * y + m[12];
+        v.y = m[1] * x + m[5] * y + m[13];
+        v.z = m[2] * x + m[6] * y + m[14];
+
+        if (uv) {
+            v.s = uv[i][0];
+            v.t = uv[i][1];
+        } else {
+            v.s = 0;
+            v.t = 0;
+        }
+
+        v.color[0] = rgba[0];
+        v.color[1] = rgba[1];
+        v.color[2] = rgba[2];
+        v.color[3] = rgba[3];
+
+        batchVertices.push_back(v);
+    }
+}
+
+/**
+ * Draw all batched quads.
+ */
+void AminoRenderer::flushBatch() {
+    if (batchVertices.empty()) {
+        return;
+    }
+
+    //shader
+    QuadBatchShader *shader = batchShaders[batchMode];
+
+    if (!shader) {
+        shader = new QuadBatchShader(batchMode);
+
+        bool res = shader->create();
+
+        r_assert(res);
+
+        batchShaders[batchMode] = shader;
+    }
+
+    ctx->useShader(shader);
+    shader->setTransformation(modelView, NULL);
+
+    //texture
+    if (batchMode != QuadBatchShader::MODE_COLOR) {
+        ctx->bindTexture(batchTexture);
+    }
+
+    //blend
+    if (batchBlend) {
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    }
+
+    //static index buffer (two triangles per quad)
+    if (batchIBO == INVALID_BUFFER) {
+        std::vector<GLushort> indices;
+
+        indices.reserve(MAX_BATCH_QUADS * 6);
+
+        for (GLushort i = 0; i < MAX_BATCH_QUADS; i++) {
+            GLushort base = i * 4;
+
+            indices.push_back(base);
+            indices.push_back(base + 1);
+            indices.push_back(base + 2);
+            indices.push_back(base);
+            indices.push_back(base + 2);
+            indices.push_back(base + 3);
+        }
+
+        glGenBuffers(1, &batchIBO);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, batchIBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLushort) * indices.size(), indices.data(), GL_STATIC_DRAW);
+    } else {
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, batchIBO);
+    }
+
+    //streaming vertex buffer (orphaned on each upload)
+    if (batchVBO == INVALID_BUFFER) {
+        glGenBuffers(1, &batchVBO);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, batchVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(amino_batch_vertex_t) * batchVertices.size(), batchVertices.data(), GL_STREAM_DRAW);
+
+    //draw
+    std::size_t quads = batchVertices.size() / 4;
+
+    shader->setBatchVertexData(NULL);
+    shader->drawElements(NULL, quads * 6, GL_TRIANGLES);
+
+    drawCalls++;
+    batchedQuads += quads;
+
+    //cleanup
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    if (batchBlend) {
+        glDisable(GL_BLEND);
+    }
+
+    batchVertices.clear();
+}
+
 /**
  * Get texture for atlas.
  *
@@ -1046,6 +1891,17 @@ amino_atlas_t AminoRenderer::getAtlasTexture(texture_atlas_t *atlas, bool create
     return res;
 }
 
+/**
+ * Upload the modified parts of an atlas.
+ *
+ * Note: has to be called on OpenGL thread.
+ */
+void AminoRenderer::uploadAtlasTexture(texture_atlas_t *atlas) {
+    r_assert(fontShader);
+
+    fontShader->uploadAtlasTexture(atlas);
+}
+
 /**
  * Output all occured OpenGL errors.
  */
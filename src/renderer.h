@@ -5,15 +5,18 @@
 
 #include "mathutils.h"
 
-#include <stack>
+#include <vector>
 
 /**
  * Rendering context.
  */
 class GLContext {
 public:
-    std::stack<void *> matrixStack;
-    GLfloat *globaltx = new GLfloat[16];
+    //preallocated stacks (grow with scene depth, never shrink)
+    std::vector<GLfloat> matrixStack;
+    std::vector<GLfloat> opacityStack;
+
+    GLfloat globaltx[16];
     GLfloat opacity = 1;
 
     int depth = 0;
@@ -27,6 +30,9 @@ public:
     GLContext() {
         //matrix
         make_identity_matrix(globaltx);
+
+        matrixStack.reserve(16 * 32);
+        opacityStack.reserve(32);
     }
 
     /**
@@ -34,7 +40,7 @@ public:
      */
     virtual ~GLContext() {
         assert(matrixStack.empty());
-        delete[] globaltx;
+        assert(opacityStack.empty());
     }
 
     /**
@@ -42,6 +48,7 @@ public:
      */
     void reset() {
         assert(matrixStack.empty());
+        assert(opacityStack.empty());
         assert(depth == 0);
 
         //reset
@@ -78,12 +85,7 @@ public:
      * Translate x/y/z.
      */
     void translate(GLfloat x, GLfloat y, GLfloat z) {
-        GLfloat tr[16];
-        GLfloat trans2[16];
-
-        make_trans_matrix(x, y, z, tr);
-        mul_matrix(trans2, globaltx, tr);
-        copy_matrix(globaltx, trans2);
+        mul_trans_matrix(globaltx, x, y, z);
     }
 
     /**
@@ -93,34 +95,38 @@ public:
      */
     void rotate(GLfloat x, GLfloat y, GLfloat z) {
         GLfloat rot[16];
-        GLfloat temp[16];
 
         //x-rotation
-        make_x_rot_matrix(x, rot);
-        mul_matrix(temp, globaltx, rot);
-        copy_matrix(globaltx, temp);
+        if (x != 0) {
+            make_x_rot_matrix(x, rot);
+            mul_matrix(globaltx, globaltx, rot);
+        }
 
         //y-rotation
-        make_y_rot_matrix(y, rot);
-        mul_matrix(temp, globaltx, rot);
-        copy_matrix(globaltx, temp);
+        if (y != 0) {
+            make_y_rot_matrix(y, rot);
+            mul_matrix(globaltx, globaltx, rot);
+        }
 
         //z-rotation
-        make_z_rot_matrix(z, rot);
-        mul_matrix(temp, globaltx, rot);
-        copy_matrix(globaltx, temp);
+        if (z != 0) {
+            make_z_rot_matrix(z, rot);
+            mul_matrix(globaltx, globaltx, rot);
+        }
     }
 
     /**
      * Scale in x und y directions.
      */
     void scale(GLfloat x, GLfloat y) {
-        GLfloat scale[16];
-        GLfloat temp[16];
+        mul_scale_matrix(globaltx, x, y, 1);
+    }
 
-        make_scale_matrix(x, y, 1.0, scale);
-        mul_matrix(temp, globaltx, scale);
-        copy_matrix(globaltx, temp);
+    /**
+     * Apply a transformation matrix.
+     */
+    void multiply(const GLfloat *m) {
+        mul_matrix(globaltx, globaltx, m);
     }
 
     /**
@@ -136,46 +142,36 @@ public:
      * Save opacity.
      */
     void saveOpacity() {
-        GLfloat *temp = new GLfloat[1];
-
-        temp[0] = opacity;
-        matrixStack.push(temp);
+        opacityStack.push_back(opacity);
     }
 
     /**
      * Restore the opacity.
      */
     void restoreOpacity() {
-        GLfloat *temp = (GLfloat *)matrixStack.top();
-
-        matrixStack.pop();
+        assert(!opacityStack.empty());
 
-        opacity = temp[0];
-        delete[] temp;
+        opacity = opacityStack.back();
+        opacityStack.pop_back();
     }
 
     /**
      * Save matrix.
      */
     void save() {
-        //matrix
-        GLfloat *temp = new GLfloat[16];
-
-        copy_matrix(temp, globaltx);
-        matrixStack.push(globaltx);
-        globaltx = temp;
+        matrixStack.insert(matrixStack.end(), globaltx, globaltx + 16);
     }
 
     /**
      * Restore matrix.
      */
     void restore() {
-        //matrix
-        delete[] globaltx;
-        globaltx = (GLfloat *)matrixStack.top();
-        matrixStack.pop();
+        std::size_t size = matrixStack.size();
+
+        assert(size >= 16);
 
-        assert(globaltx);
+        copy_matrix(globaltx, matrixStack.data() + size - 16);
+        matrixStack.resize(size - 16);
     }
 
     /**
@@ -215,6 +211,13 @@ public:
         bindTexture(0);
     }
 
+    /**
+     * Texture was bound by other code (next bindTexture() call binds again).
+     */
+    void invalidateTexture() {
+        prevTex = INVALID_TEXTURE;
+    }
+
     /**
      * Check if depth buffer is active.
      */
@@ -278,26 +281,45 @@ public:
     virtual void renderScene(AminoNode *node);
 
     amino_atlas_t getAtlasTexture(texture_atlas_t *atlas, bool createIfMissing, bool &newTexture);
+    void uploadAtlasTexture(texture_atlas_t *atlas);
 
     static int showGLErrors();
     static int showGLErrors(std::string msg);
 
     static void checkTexturePerformance();
 
+    //stats (last frame)
+    uint32_t lastDrawCalls = 0;
+    uint32_t lastBatchedQuads = 0;
+    uint32_t lastCulledNodes = 0;
+
 protected:
     virtual void render(AminoNode *node);
+    void applyTransform(AminoNode *node);
+
+    void getScreenBounds(GLfloat x1, GLfloat y1, GLfloat x2, GLfloat y2, GLfloat bounds[4]);
+    bool isVisible(GLfloat x1, GLfloat y1, GLfloat x2, GLfloat y2);
+    bool getLocalBounds(AminoNode *node, GLfloat bounds[4]);
+    bool isCulled(AminoNode *node);
+
+    int32_t addHitEntry(AminoNode *node);
+
+    void applyScissor(GLfloat w, GLfloat h);
+    void drawClipStencil(AminoGroup *group, GLenum op);
 
     virtual void drawGroup(AminoGroup *group);
     virtual void drawRect(AminoRect *rect);
     virtual void drawPoly(AminoPolygon *poly);
     virtual void drawModel(AminoModel *model);
     virtual void drawText(AminoText *text);
+    void drawSdfText(AminoText *text, GLfloat opacity);
 
 private:
     AminoGfx *gfx;
 
     //basic shaders
     AminoFontShader *fontShader = NULL;
+    AminoFontSdfShader *sdfFontShader = NULL; //created on first use
     ColorShader *colorShader = NULL;
     TextureShader *textureShader = NULL;
     TextureClampToBorderShader *textureClampToBorderShader = NULL;
@@ -323,6 +345,44 @@ private:
     GLfloat modelView[16];
     GLContext *ctx = NULL;
 
+    //quad batch
+    QuadBatchShader *batchShaders[3] = { NULL, NULL, NULL };
+    std::vector<amino_batch_vertex_t> batchVertices;
+    GLuint batchVBO = INVALID_BUFFER;
+    GLuint batchIBO = INVALID_BUFFER;
+    int batchMode = -1;
+    GLuint batchTexture = INVALID_TEXTURE;
+    bool batchBlend = false;
+
+    //SDF text
+    std::vector<GLushort> sdfIndices;
+
+    //culling
+    bool screenAligned = false;
+    bool cullingEnabled = false;
+    GLfloat sceneW = 0;
+    GLfloat sceneH = 0;
+    GLfloat viewportW = 0;
+    GLfloat viewportH = 0;
+    GLfloat clipBounds[4];
+
+    //hit testing
+    bool recordHits = false;
+    int32_t hitClip = -1;
+
+    //clipping
+    bool scissorEnabled = false;
+    GLint scissorBox[4] = { 0, 0, 0, 0 };
+    GLint stencilDepth = 0;
+
+    //stats
+    uint32_t drawCalls = 0;
+    uint32_t batchedQuads = 0;
+    uint32_t culledNodes = 0;
+
+    void addQuad(int mode, GLuint texId, bool blend, GLfloat verts[4][2], GLfloat uv[4][2], GLfloat color[4]);
+    void flushBatch();
+
     void applyColorShader(GLfloat *verts, GLsizei dim, GLsizei count, GLfloat color[4], GLenum mode = GL_TRIANGLES);
     void applyTextureShader(GLfloat *verts, GLsizei dim, GLsizei count, GLfloat uv[][2], GLuint texId, GLfloat opacity, bool needsClampToBorder, bool repeatX, bool repeatY);
 };
@@ -1,12 +1,14 @@
 #include "shaders.h"
 
+#include <cstddef>
+
 //#include "mathutils.h"
 
 #define INVALID_SHADER 0
 
 #define DEBUG_SHADER_ERRORS true
 
-#ifdef RPI
+#if defined(RPI) || defined(HEADLESS)
 #define PRECISION
 #endif
 
@@ -125,7 +127,7 @@ GLuint AnyShader::compileShader(std::string source, const GLenum type) {
     source = "#define EGL_GBM\n" + source;
 #endif
 
-#ifdef RPI
+#if defined(RPI) || defined(HEADLESS)
     //add GLSL version
     source = "#version 100\n" + source;
 #endif
@@ -735,3 +737,162 @@ void TextureLightingShader::drawElements(GLushort *indices, GLsizei elements, GL
 
     glDisableVertexAttribArray(aNormal);
 }
+
+//
+// QuadBatchShader
+//
+
+/**
+ * Create quad batch shader.
+ */
+QuadBatchShader::QuadBatchShader(int mode) : AnyAminoShader(), mode(mode) {
+    //shaders
+    if (mode == MODE_COLOR) {
+        vertexShader = R"(
+            uniform mat4 mvp;
+
+            attribute vec4 pos;
+            attribute vec4 color;
+
+            varying vec4 vColor;
+
+            void main() {
+                gl_Position = mvp * pos;
+                vColor = color;
+            }
+        )";
+
+        fragmentShader = R"(
+            varying vec4 vColor;
+
+            void main() {
+                gl_FragColor = vColor;
+            }
+        )";
+
+        return;
+    }
+
+    vertexShader = R"(
+        uniform mat4 mvp;
+
+        attribute vec4 pos;
+        attribute vec2 texCoord;
+        attribute vec4 color;
+
+        varying vec2 uv;
+        varying vec4 vColor;
+
+        void main() {
+            gl_Position = mvp * pos;
+            uv = texCoord;
+            vColor = color;
+        }
+    )";
+
+    if (mode == MODE_TEXTURE) {
+        //same as texture shader (opacity in alpha channel)
+        fragmentShader = R"(
+            varying vec2 uv;
+            varying vec4 vColor;
+
+            uniform sampler2D tex;
+
+            void main() {
+                vec4 pixel = texture2D(tex, uv);
+
+                //discard transparent pixels
+                if (pixel.a == 0.) {
+                    discard;
+                }
+
+                gl_FragColor = vec4(pixel.rgb, pixel.a * vColor.a);
+            }
+        )";
+    } else {
+        //same as font shader
+        fragmentShader = R"(
+            varying vec2 uv;
+            varying vec4 vColor;
+
+            uniform sampler2D tex;
+
+            void main() {
+                float a = texture2D(tex, uv).a;
+
+                gl_FragColor = vec4(vColor.rgb, vColor.a * a);
+            }
+        )";
+    }
+}
+
+/**
+ * Initialize the shader.
+ */
+void QuadBatchShader::initShader() {
+    useShader(false);
+
+    //attributes
+    aPos = getAttributeLocation("pos");
+    aColor = getAttributeLocation("color");
+
+    if (mode != MODE_COLOR) {
+        aTexCoord = getAttributeLocation("texCoord");
+    }
+
+    //uniforms
+    uMVP = getUniformLocation("mvp");
+
+    if (mode != MODE_COLOR) {
+        uTex = getUniformLocation("tex");
+
+        //default values
+        glUniform1i(uTex, 0); //GL_TEXTURE0
+    }
+}
+
+/**
+ * Set transformation matrix.
+ *
+ * Note: vertices are already transformed.
+ */
+void QuadBatchShader::setTransformation(GLfloat modelView[16], GLfloat transition[16]) {
+    glUniformMatrix4fv(uMVP, 1, GL_FALSE, modelView);
+}
+
+/**
+ * Set interleaved vertex data.
+ *
+ * Note: vertices is NULL in case of VBO usage
+ */
+void QuadBatchShader::setBatchVertexData(amino_batch_vertex_t *vertices) {
+    GLsizei stride = sizeof(amino_batch_vertex_t);
+    char *base = (char *)vertices;
+
+    glVertexAttribPointer(aPos, 3, GL_FLOAT, GL_FALSE, stride, base + offsetof(amino_batch_vertex_t, x));
+    glVertexAttribPointer(aColor, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, base + offsetof(amino_batch_vertex_t, color));
+
+    if (aTexCoord != -1) {
+        glVertexAttribPointer(aTexCoord, 2, GL_FLOAT, GL_FALSE, stride, base + offsetof(amino_batch_vertex_t, s));
+    }
+}
+
+/**
+ * Draw elements.
+ */
+void QuadBatchShader::drawElements(GLushort *indices, GLsizei elements, GLenum mode) {
+    glEnableVertexAttribArray(aColor);
+
+    if (aTexCoord != -1) {
+        glEnableVertexAttribArray(aTexCoord);
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    AnyAminoShader::drawElements(indices, elements, mode);
+
+    if (aTexCoord != -1) {
+        glDisableVertexAttribArray(aTexCoord);
+    }
+
+    glDisableVertexAttribArray(aColor);
+}
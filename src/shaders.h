@@ -167,4 +167,44 @@ protected:
     void initShader() override;
 };
 
+/**
+ * Quad batch vertex (pre-transformed).
+ */
+typedef struct {
+    GLfloat x, y, z;  //position
+    GLfloat s, t;     //texture pos
+    GLubyte color[4]; //RGBA
+} amino_batch_vertex_t;
+
+/**
+ * Quad batch shader (per vertex color, pre-transformed positions).
+ */
+class QuadBatchShader : public AnyAminoShader {
+public:
+    //modes
+    static const int MODE_COLOR = 0;
+    static const int MODE_TEXTURE = 1;
+    static const int MODE_ALPHA_TEXTURE = 2;
+
+    QuadBatchShader(int mode);
+
+    //params
+    void setTransformation(GLfloat modelView[16], GLfloat transition[16]) override;
+
+    //per vertex data
+    void setBatchVertexData(amino_batch_vertex_t *vertices);
+
+    //draw
+    void drawElements(GLushort *indices, GLsizei elements, GLenum mode) override;
+
+protected:
+    int mode;
+
+    GLint aTexCoord = -1;
+    GLint aColor;
+    GLint uTex;
+
+    void initShader() override;
+};
+
 #endif
\ No newline at end of file
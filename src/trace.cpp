@@ -0,0 +1,178 @@
+#include "trace.h"
+
+#include <chrono>
+#include <sstream>
+#include <thread>
+
+//
+// AminoTraceBuffer
+//
+
+AminoTraceBuffer::AminoTraceBuffer(uint32_t threadId): threadId(threadId) {
+    //empty
+}
+
+//
+// AminoTrace
+//
+
+/**
+ * Start recording.
+ *
+ * Note: called on main thread.
+ */
+void AminoTrace::start() {
+    active = true;
+}
+
+/**
+ * Stop recording, get the trace event JSON and free the buffers.
+ *
+ * Note: called on main thread.
+ */
+std::string AminoTrace::stop() {
+    active = false;
+
+    //wait for threads still adding an event
+    while (writers.load() > 0) {
+        std::this_thread::yield();
+    }
+
+    std::ostringstream ss;
+    bool first = true;
+
+    ss << "{\"traceEvents\":[";
+
+    buffersLock.lock();
+
+    for (auto const &buffer : buffers) {
+        //thread name
+        if (!buffer->threadName.empty()) {
+            if (!first) {
+                ss << ",";
+            }
+
+            ss << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadId << ",\"args\":{\"name\":\"" << buffer->threadName << "\"}}";
+            first = false;
+        }
+
+        //events (oldest first)
+        uint32_t pos = buffer->writePos.load(std::memory_order_acquire);
+        uint32_t count = pos < AminoTraceBuffer::SIZE ? pos:AminoTraceBuffer::SIZE;
+
+        for (uint32_t i = pos - count; i < pos; i++) {
+            amino_trace_event_t &event = buffer->events[i % AminoTraceBuffer::SIZE];
+
+            if (!first) {
+                ss << ",";
+            }
+
+            ss << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadId << ",\"ts\":" << event.ts << ",\"dur\":" << event.dur << "}";
+            first = false;
+        }
+
+        delete buffer;
+    }
+
+    //threads allocate a new buffer in the next session
+    buffers.clear();
+    session++;
+
+    buffersLock.unlock();
+
+    ss << "],\"displayTimeUnit\":\"ms\"}";
+
+    return ss.str();
+}
+
+/**
+ * Check if recording.
+ */
+bool AminoTrace::isActive() {
+    return active.load(std::memory_order_relaxed);
+}
+
+/**
+ * Get monotonic time in microseconds.
+ */
+int64_t AminoTrace::now() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Add an event to the buffer of the current thread.
+ */
+void AminoTrace::add(const char *name, int64_t start, int64_t end) {
+    //Note: stop() waits until no writer is left before reading and freeing the buffers
+    writers++;
+
+    if (!active) {
+        writers--;
+        return;
+    }
+
+    AminoTraceBuffer *buffer = getThreadBuffer();
+    uint32_t pos = buffer->writePos.load(std::memory_order_relaxed);
+    amino_trace_event_t &event = buffer->events[pos % AminoTraceBuffer::SIZE];
+
+    event.name = name;
+    event.ts = start;
+    event.dur = end - start;
+
+    //publish
+    buffer->writePos.store(pos + 1, std::memory_order_release);
+
+    writers--;
+}
+
+/**
+ * Name the current thread in the trace output.
+ *
+ * Note: name has to be a static string.
+ */
+void AminoTrace::setThreadName(const char *name) {
+    threadName = name;
+
+    //update existing buffer
+    buffersLock.lock();
+
+    if (threadBuffer && threadSession == session) {
+        threadBuffer->threadName = name;
+    }
+
+    buffersLock.unlock();
+}
+
+/**
+ * Get (or create) the buffer of the current thread.
+ *
+ * Note: buffers are only allocated once a thread records events and freed when recording stops.
+ */
+AminoTraceBuffer* AminoTrace::getThreadBuffer() {
+    if (!threadBuffer || threadSession != session) {
+        buffersLock.lock();
+
+        threadBuffer = new AminoTraceBuffer(buffers.size() + 1);
+        threadSession = session;
+
+        if (threadName) {
+            threadBuffer->threadName = threadName;
+        }
+
+        buffers.push_back(threadBuffer);
+
+        buffersLock.unlock();
+    }
+
+    return threadBuffer;
+}
+
+//static initializers
+std::atomic<bool> AminoTrace::active { false };
+std::atomic<uint32_t> AminoTrace::writers { 0 };
+std::atomic<uint32_t> AminoTrace::session { 0 };
+std::mutex AminoTrace::buffersLock;
+std::vector<AminoTraceBuffer *> AminoTrace::buffers;
+thread_local AminoTraceBuffer *AminoTrace::threadBuffer = NULL;
+thread_local uint32_t AminoTrace::threadSession = 0;
+thread_local const char *AminoTrace::threadName = NULL;
@@ -0,0 +1,96 @@
+#ifndef _AMINO_TRACE_H
+#define _AMINO_TRACE_H
+
+#include <stdint.h>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <mutex>
+
+/**
+ * Trace event (complete event with duration).
+ */
+typedef struct {
+    const char *name; //Note: static string
+    int64_t ts;       //start (microseconds)
+    int64_t dur;      //duration (microseconds)
+} amino_trace_event_t;
+
+/**
+ * Trace events of a single thread (ring buffer).
+ *
+ * Note: only the owning thread writes, events up to writePos are read after all writers left add().
+ */
+class AminoTraceBuffer {
+public:
+    static const uint32_t SIZE = 1 << 16;
+
+    std::string threadName;
+    uint32_t threadId;
+    std::atomic<uint32_t> writePos { 0 };
+    amino_trace_event_t events[SIZE];
+
+    AminoTraceBuffer(uint32_t threadId);
+};
+
+/**
+ * Chrome trace event recorder.
+ *
+ * Output can be loaded in chrome://tracing or Perfetto.
+ */
+class AminoTrace {
+public:
+    static void start();
+    static std::string stop();
+    static bool isActive();
+
+    static int64_t now();
+    static void add(const char *name, int64_t start, int64_t end);
+    static void setThreadName(const char *name);
+
+private:
+    static std::atomic<bool> active;
+    static std::atomic<uint32_t> writers;
+    static std::atomic<uint32_t> session;
+    static std::mutex buffersLock;
+    static std::vector<AminoTraceBuffer *> buffers;
+    static thread_local AminoTraceBuffer *threadBuffer;
+    static thread_local uint32_t threadSession;
+    static thread_local const char *threadName;
+
+    static AminoTraceBuffer* getThreadBuffer();
+};
+
+/**
+ * Trace scope (records the time until the end of the block).
+ */
+class AminoTraceScope {
+public:
+    /**
+     * Begin scope.
+     */
+    AminoTraceScope(const char *name): name(name) {
+        if (AminoTrace::isActive()) {
+            start = AminoTrace::now();
+        }
+    }
+
+    /**
+     * End scope.
+     */
+    ~AminoTraceScope() {
+        if (start >= 0 && AminoTrace::isActive()) {
+            AminoTrace::add(name, start, AminoTrace::now());
+        }
+    }
+
+private:
+    const char *name;
+    int64_t start = -1;
+};
+
+#define TRACE_CONCAT2(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT2(a, b)
+#define TRACE_SCOPE(name) AminoTraceScope TRACE_CONCAT(traceScope, __LINE__)(name)
+
+#endif